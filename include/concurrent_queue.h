@@ -0,0 +1,154 @@
+#ifndef CONCURRENT_QUEUE_H
+#define CONCURRENT_QUEUE_H
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Thread-safe ready queues for feeding a live dispatcher
+//
+// concurrent_ring_t is a bounded lock-free multi-producer/single-consumer FIFO (FCFS, RR).
+// Any number of threads may push, exactly one thread may pop.
+//
+// concurrent_heap_t is a mutex-protected min-heap ordered on a key pulled out of each object (SJF, priority).
+// Any number of threads may push and pop. Equal keys come out in push order.
+//
+// Both copy objects in and out by value like dyn_array, so hand them the PCB, not a pointer to it.
+// Batch operations claim/lock once for the whole batch, prefer them when you have more than one object.
+
+typedef struct concurrent_ring concurrent_ring_t;
+typedef struct concurrent_heap concurrent_heap_t;
+
+///
+/// Creates a new lock-free MPSC ring
+/// \param capacity Number of slots, rounded up to a power of two (fixed, the ring never grows)
+/// \param data_type_size Size of the object type to be stored in bytes
+/// \return new ring pointer, NULL on error
+///
+concurrent_ring_t *concurrent_ring_create(const size_t capacity, const size_t data_type_size);
+
+///
+/// Ring destructor, must not race with any other operation on the ring
+/// \param ring the ring to destruct
+///
+void concurrent_ring_destroy(concurrent_ring_t *const ring);
+
+///
+/// Copies the object onto the back of the ring (any thread)
+/// \param ring the ring
+/// \param object the object to insert
+/// \return true on success, false if the ring is full or on error
+///
+bool concurrent_ring_push(concurrent_ring_t *const ring, const void *const object);
+
+///
+/// Copies a contiguous batch of objects onto the back of the ring in one claim (any thread)
+/// The batch stays contiguous in the ring, other producers can't interleave with it
+/// \param ring the ring
+/// \param objects the objects to insert
+/// \param count number of objects
+/// \return true if the whole batch went in, false (nothing inserted) if it doesn't fit or on error
+///
+bool concurrent_ring_push_batch(concurrent_ring_t *const ring, const void *const objects, const size_t count);
+
+///
+/// Removes the object at the front of the ring and places it in the desired location (consumer thread only)
+/// \param ring the ring
+/// \param object destination for extracted object
+/// \return true on success, false if the ring is empty or on error
+///
+bool concurrent_ring_pop(concurrent_ring_t *const ring, void *const object);
+
+///
+/// Removes up to max_count objects from the front of the ring (consumer thread only)
+/// Stops early at the first slot a producer hasn't finished publishing
+/// \param ring the ring
+/// \param objects destination array, room for max_count objects
+/// \param max_count maximum number of objects to extract
+/// \return number of objects extracted
+///
+size_t concurrent_ring_pop_batch(concurrent_ring_t *const ring, void *const objects, const size_t max_count);
+
+///
+/// Returns the number of objects in the ring
+/// Only a snapshot while producers are running
+/// \param ring the ring
+/// \return the size of the ring, 0 on error
+///
+size_t concurrent_ring_size(const concurrent_ring_t *const ring);
+
+///
+/// Returns the fixed capacity of the ring
+/// \param ring the ring
+/// \return the capacity of the ring, 0 on error
+///
+size_t concurrent_ring_capacity(const concurrent_ring_t *const ring);
+
+
+
+///
+/// Creates a new locked min-heap
+/// \param capacity Minimum capacity request (0 is fine if you have no opinion), grows as needed
+/// \param data_type_size Size of the object type to be stored in bytes
+/// \param key_func Returns the ordering key of an object, smallest comes out first
+/// \return new heap pointer, NULL on error
+///
+concurrent_heap_t *concurrent_heap_create(const size_t capacity, const size_t data_type_size,
+                                          uint64_t (*const key_func)(const void *const));
+
+///
+/// Heap destructor, must not race with any other operation on the heap
+/// \param heap the heap to destruct
+///
+void concurrent_heap_destroy(concurrent_heap_t *const heap);
+
+///
+/// Copies the object into the heap
+/// \param heap the heap
+/// \param object the object to insert
+/// \return bool representing success of the operation
+///
+bool concurrent_heap_push(concurrent_heap_t *const heap, const void *const object);
+
+///
+/// Copies a batch of objects into the heap under a single lock acquisition
+/// \param heap the heap
+/// \param objects the objects to insert
+/// \param count number of objects
+/// \return true if the whole batch went in, false on error (an allocation failure can leave part of it in)
+///
+bool concurrent_heap_push_batch(concurrent_heap_t *const heap, const void *const objects, const size_t count);
+
+///
+/// Removes the smallest object and places it in the desired location
+/// \param heap the heap
+/// \param object destination for extracted object
+/// \return true on success, false if the heap is empty or on error
+///
+bool concurrent_heap_pop(concurrent_heap_t *const heap, void *const object);
+
+///
+/// Removes up to max_count of the smallest objects, in order, under a single lock acquisition
+/// \param heap the heap
+/// \param objects destination array, room for max_count objects
+/// \param max_count maximum number of objects to extract
+/// \return number of objects extracted
+///
+size_t concurrent_heap_pop_batch(concurrent_heap_t *const heap, void *const objects, const size_t max_count);
+
+///
+/// Returns the number of objects in the heap
+/// \param heap the heap
+/// \return the size of the heap, 0 on error
+///
+size_t concurrent_heap_size(concurrent_heap_t *const heap);
+
+#ifdef __cplusplus
+  }
+#endif
+
+#endif
@@ -11,6 +11,8 @@
 #include <string.h>
 #include <stdint.h>
 
+struct dyn_array_counters;
+
 struct dyn_array 
 {
     // DYN_FLAGS flags;
@@ -19,12 +21,13 @@ struct dyn_array
     const size_t data_size;
     void *array;
     void (*destructor)(void *);
+    const unsigned int allocation;  // dyn_alloc_flags_t, see dyn_array_create_with
+#ifdef DYN_ARRAY_STATS
+    struct dyn_array_counters *stats;   // see dyn_array_get_stats, separate so const arrays can still count reads
+#endif
 };
 
 typedef struct dyn_array dyn_array_t;
-// Next version, push/pop_N_back/front for bulk loading
-// Erase_n
-// etc
 
 /*
     Destructor notes!
@@ -54,6 +57,40 @@ typedef struct dyn_array dyn_array_t;
 ///
 dyn_array_t *dyn_array_create(const size_t capacity, const size_t data_type_size, void (*destruct_func)(void *));
 
+/*
+    Allocation notes!
+
+    Storage is plain malloc/realloc unless asked otherwise at creation, flags can be or'd together.
+
+    DYN_ALLOC_HUGE_PAGES: once the storage is at least a huge page (2MB) it's allocated 2MB aligned and
+      madvised for transparent huge pages, so a sweep over a big array isn't a TLB miss every 4KB.
+      Smaller storage stays on malloc. Growing past 2MB moves to aligned storage rather than realloc'ing,
+      and dyn_array_sort_parallel's merge buffer gets the same treatment.
+      Does nothing where the kernel has no madvise(MADV_HUGEPAGE).
+
+    DYN_ALLOC_FIRST_TOUCH: storage is faulted in, a page at a time, by whichever thread allocates or grows it.
+      Linux puts a page on the NUMA node of the thread that first touches it, so an array created and grown
+      by a worker stays local to that worker even if another thread would have written it first.
+*/
+typedef enum
+{
+    DYN_ALLOC_DEFAULT = 0x00,
+    DYN_ALLOC_HUGE_PAGES = 0x01,
+    DYN_ALLOC_FIRST_TOUCH = 0x02,
+}
+dyn_alloc_flags_t;
+
+///
+/// Creates a new dynamic array like dyn_array_create, with storage allocated as the flags ask
+/// \param capacity Minimum capacity request (0 is fine if you have no opinion)
+/// \param data_type_size Size of the object type to be stored in bytes
+/// \param destruct_func Optional destructor to be applied on destruct operations (NULL to disable)
+/// \param allocation dyn_alloc_flags_t values or'd together
+/// \return new dynamic array pointer, NULL on error
+///
+dyn_array_t *dyn_array_create_with(const size_t capacity, const size_t data_type_size,
+                                   void (*destruct_func)(void *), const unsigned int allocation);
+
 ///
 /// Creates a new dynamic array from a given array
 /// (Given pointer can be freed after import, we copy the data)
@@ -195,6 +232,98 @@ bool dyn_array_erase(dyn_array_t *const dyn_array, const size_t index);
 bool dyn_array_extract(dyn_array_t *const dyn_array, const size_t index, void *const object);
 
 
+// Range versions of the above, count objects at a time for the price of one memmove/memcpy
+// A count of 0 is an error, same as passing NULL
+
+///
+/// Copies count objects onto the back of the array
+/// \param dyn_array the dynamic array
+/// \param objects the objects to append, contiguous
+/// \param count number of objects
+/// \return bool representing success of the operation (nothing is appended on failure)
+///
+bool dyn_array_append(dyn_array_t *const dyn_array, const void *const objects, const size_t count);
+
+///
+/// Copies count objects into the array starting at index, moving everything from index on down by count
+/// \param dyn_array the dynamic array
+/// \param index the position the first object ends up at, up to and including the size
+/// \param objects the objects to insert, contiguous
+/// \param count number of objects
+/// \return bool representing success of the operation (nothing is inserted on failure)
+///
+bool dyn_array_insert_range(dyn_array_t *const dyn_array, const size_t index, const void *const objects,
+                            const size_t count);
+
+///
+/// Removes and optionally destructs count objects starting at index
+/// \param dyn_array the dynamic array
+/// \param index index of the first object to erase
+/// \param count number of objects, the range must lie within the array
+/// \return bool representing success of the operation
+///
+bool dyn_array_erase_range(dyn_array_t *const dyn_array, const size_t index, const size_t count);
+
+///
+/// Removes count objects starting at index and places them at the desired location
+/// Does not destruct the objects since they are returned to the user
+/// \param dyn_array the dynamic array
+/// \param index index of the first object to extract
+/// \param count number of objects, the range must lie within the array
+/// \param objects destination for the extracted objects, room for count of them
+/// \return bool representing success of the operation
+///
+bool dyn_array_extract_range(dyn_array_t *const dyn_array, const size_t index, const size_t count,
+                             void *const objects);
+
+///
+/// Moves count objects starting at source_index out of source and into destination at destination_index
+/// Ownership moves with the objects, so no destructors run. The arrays must be different and hold the same size
+/// of object (destructors are not checked, mixing them is on you)
+/// \param destination the array receiving the objects
+/// \param destination_index the position the first object ends up at, up to and including its size
+/// \param source the array giving up the objects
+/// \param source_index index of the first object to move
+/// \param count number of objects, the range must lie within source
+/// \return bool representing success of the operation (neither array changes on failure)
+///
+bool dyn_array_splice(dyn_array_t *const destination, const size_t destination_index, dyn_array_t *const source,
+                      const size_t source_index, const size_t count);
+
+
+// Unordered removal, for arrays used as bags where order doesn't matter
+// The last object moves into the gap, so these are O(1) but reorder the array
+
+///
+/// Removes and optionally destructs the object at the given index, moving the last object into its place
+/// \param dyn_array the dynamic array
+/// \param index index of the object to be erased
+/// \return bool representing success of the operation
+///
+bool dyn_array_swap_erase(dyn_array_t *const dyn_array, const size_t index);
+
+///
+/// Removes the object at the given index and places it at the desired location, moving the last object into its place
+/// Does not destruct the object since it is returned to the user
+/// \param dyn_array the dynamic array
+/// \param index the index of the object to extract
+/// \param object destination for extracted object
+/// \return bool representing success of the operation
+///
+bool dyn_array_swap_extract(dyn_array_t *const dyn_array, const size_t index, void *const object);
+
+///
+/// Removes (and optionally destructs) every object the predicate accepts in one pass, the rest keep their order
+/// The predicate sees each object exactly once and runs before any destructor, so it may look at anything
+/// \param dyn_array the dynamic array
+/// \param predicate returns true for objects to remove
+/// \param arg argument that will be passed to the predicate (as parameter 2)
+/// \return number of objects removed, 0 on error
+///
+size_t dyn_array_remove_if(dyn_array_t *const dyn_array, bool (*const predicate)(const void *const, void *),
+                           void *arg);
+
+
 ///
 /// Removes and optionally destructs all array elements
 /// \param dyn_array the dynamic array
@@ -241,11 +370,27 @@ size_t dyn_array_data_size(const dyn_array_t *const dyn_array);
 ///
 bool dyn_array_sort(dyn_array_t *const dyn_array, int (*const compare)(const void *, const void *));
 
+///
+/// Sorts the contents of the object on several threads
+/// Each thread qsorts a chunk, then the chunks are merged pairwise with every thread taking an equal share
+/// of each merge's output, so no pass is left to a single thread
+/// Arrays under DYN_PARALLEL_SORT_THRESHOLD objects (and single threads) are just handed to dyn_array_sort,
+/// as is everything if the merge buffer can't be allocated
+/// Like dyn_array_sort, equal objects come out in no particular order
+/// \param dyn_array the dynamic array
+/// \param compare the comparison function, called from several threads at once
+/// \param threads the most threads to use, 0 for one per online CPU
+/// \return bool representing success of the operation
+///
+bool dyn_array_sort_parallel(dyn_array_t *const dyn_array, int (*const compare)(const void *, const void *),
+                             const size_t threads);
+
 
 ///
 /// Inserts the given object into the correct sorted position
 ///  increasing the container size by one
 /// and moving any contents beyond the sorted position down one
+/// The position is found by binary search, ahead of any objects that compare equal (see lower_bound)
 /// Note: calling this on an unsorted array will insert it... somewhere
 /// \param dyn_array the dynamic array
 /// \param object the object to insert
@@ -255,6 +400,41 @@ bool dyn_array_sort(dyn_array_t *const dyn_array, int (*const compare)(const voi
 bool dyn_array_insert_sorted(dyn_array_t *const dyn_array, const void *const object,
                              int (*const compare)(const void *const, const void *const));
 
+///
+/// Binary searches a sorted array for the first object that doesn't compare less than the given one
+/// \param dyn_array the dynamic array
+/// \param object the object to search for
+/// \param compare the comparison function
+/// \return index of that object, the size if there isn't one, 0 on error
+///
+size_t dyn_array_lower_bound(const dyn_array_t *const dyn_array, const void *const object,
+                             int (*const compare)(const void *, const void *));
+
+///
+/// Binary searches a sorted array for the first object that compares greater than the given one
+/// Inserting there puts the object after any equal ones, e.g. FIFO order among equal keys
+/// \param dyn_array the dynamic array
+/// \param object the object to search for
+/// \param compare the comparison function
+/// \return index of that object, the size if there isn't one, 0 on error
+///
+size_t dyn_array_upper_bound(const dyn_array_t *const dyn_array, const void *const object,
+                             int (*const compare)(const void *, const void *));
+
+///
+/// Merges a sorted batch of objects into a sorted array in one linear pass
+/// Equal objects keep their order, the array's ahead of the batch's, and objects in the array
+/// that don't compare greater than the batch's first object are never moved
+/// Note: the objects cannot be from the array itself
+/// \param dyn_array the dynamic array
+/// \param objects the sorted objects to merge in
+/// \param count the number of objects
+/// \param compare the comparison function
+/// \return bool representing success of the operation
+///
+bool dyn_array_merge_sorted(dyn_array_t *const dyn_array, const void *const objects, const size_t count,
+                            int (*const compare)(const void *, const void *));
+
 
 ///
 /// Applies the given function to every object in the array
@@ -265,6 +445,150 @@ bool dyn_array_insert_sorted(dyn_array_t *const dyn_array, const void *const obj
 ///
 bool dyn_array_for_each(dyn_array_t *const dyn_array, void (*const func)(void *const, void *), void *arg);
 
+///
+/// Applies the given function to the array a block of contiguous objects at a time
+/// The function loops over each block itself, so it can be inlined and vectorized where a per-object call can't
+/// It mustn't add or remove objects
+/// \param dyn_array the dynamic array
+/// \param func the function to apply, given the first object of a block and how many objects are in it
+/// \param arg argument that will be passed to the function (as parameter 3)
+/// \param block_size most objects passed per call, 0 for the whole array in one call
+/// \return bool representing success of operation (really just pointer and size checks)
+///
+bool dyn_array_for_each_block(dyn_array_t *const dyn_array, void (*const func)(void *const, const size_t, void *),
+                              void *arg, const size_t block_size);
+
+struct thread_pool;
+
+///
+/// Applies the given function to the array in contiguous chunks, one chunk per thread of a pool
+/// Each chunk gets its own accumulator, so the function needs no locking, and they're merged into the first
+/// once every chunk is done (in chunk order, so merging needn't be commutative). Small arrays, and no pool,
+/// run as a single chunk on the calling thread. It mustn't add or remove objects
+/// \param dyn_array the dynamic array
+/// \param pool the threads to use, see thread_pool.h (NULL to just run on the calling thread)
+/// \param func the function to apply, given the first object of a chunk, how many objects are in it and
+///  the chunk's accumulator
+/// \param accumulators room for thread_pool_size(pool) accumulators, all set to the starting value,
+///  the result ends up in the first (NULL if there's nothing to accumulate)
+/// \param accumulator_size size of an accumulator in bytes
+/// \param merge folds the second accumulator into the first (NULL to leave them all as they are)
+/// \return bool representing success of operation (really just pointer and size checks)
+///
+bool dyn_array_for_each_parallel(dyn_array_t *const dyn_array, struct thread_pool *const pool,
+                                 void (*const func)(void *const, const size_t, void *), void *accumulators,
+                                 const size_t accumulator_size, void (*const merge)(void *, const void *));
+
+typedef struct
+{
+    uint64_t sum;
+    uint32_t min;       // UINT32_MAX for an empty array
+    uint32_t max;       // 0 for an empty array
+}
+dyn_array_u32_reduction_t;
+
+///
+/// Sums and finds the smallest and largest of a uint32_t field across every object, in one pass
+/// e.g. offsetof(ProcessControlBlock_t, remaining_burst_time) totals the work in a ready queue
+/// \param dyn_array the dynamic array
+/// \param offset byte offset of the field within an object (uint32_t sized arrays use 0)
+/// \param reduction destination for the results
+/// \return bool representing success of the operation, false if the field doesn't fit in an object
+///
+bool dyn_array_reduce_u32(const dyn_array_t *const dyn_array, const size_t offset,
+                          dyn_array_u32_reduction_t *const reduction);
+
+
+/*
+    Statistics notes!
+
+    Build with -DDYN_ARRAY_STATS=ON (cmake) and every array counts what it does:
+    reallocations, bytes shuffled by memmove on inserts/removals, its peak capacity,
+    and calls to each operation. Without it none of this is compiled in and
+    dyn_array_get_stats just says no.
+
+    Quadratic patterns show up as bytes_moved growing much faster than the operation counts,
+    e.g. push_front/erase(0) in a loop moves the whole array every call.
+
+    Operation counts are atomic, so threads reading one array at the same time (front, at,
+    the bounds...) can share it in a stats build too. The other counters only change with the array.
+*/
+
+#ifdef DYN_ARRAY_STATS
+#define DYN_ARRAY_STATS_ENABLED 1
+#else
+#define DYN_ARRAY_STATS_ENABLED 0
+#endif
+
+typedef enum
+{
+    DYN_OP_FRONT,
+    DYN_OP_BACK,
+    DYN_OP_AT,
+    DYN_OP_PUSH_FRONT,
+    DYN_OP_POP_FRONT,
+    DYN_OP_EXTRACT_FRONT,
+    DYN_OP_PUSH_BACK,
+    DYN_OP_POP_BACK,
+    DYN_OP_EXTRACT_BACK,
+    DYN_OP_INSERT,
+    DYN_OP_ERASE,
+    DYN_OP_EXTRACT,
+    DYN_OP_CLEAR,
+    DYN_OP_SORT,
+    DYN_OP_INSERT_SORTED,
+    DYN_OP_FOR_EACH,
+    DYN_OP_APPEND,
+    DYN_OP_INSERT_RANGE,
+    DYN_OP_ERASE_RANGE,
+    DYN_OP_EXTRACT_RANGE,
+    DYN_OP_SPLICE,
+    DYN_OP_SWAP_ERASE,
+    DYN_OP_SWAP_EXTRACT,
+    DYN_OP_REMOVE_IF,
+    DYN_OP_LOWER_BOUND,
+    DYN_OP_UPPER_BOUND,
+    DYN_OP_MERGE_SORTED,
+    DYN_OP_SORT_PARALLEL,
+    DYN_OP_FOR_EACH_BLOCK,
+    DYN_OP_REDUCE_U32,
+    DYN_OP_FOR_EACH_PARALLEL,
+    DYN_OP_COUNT,
+}
+dyn_array_op_t;
+
+typedef struct dyn_array_stats
+{
+    size_t reallocs;                // times the storage was reallocated to grow
+    size_t bytes_reallocated;       // sum of the sizes asked of realloc
+    size_t bytes_moved;             // bytes memmoved to open or close gaps
+    size_t peak_capacity;           // largest capacity the array has had (objects)
+    size_t peak_size;               // most objects the array has held at once
+    size_t ops[DYN_OP_COUNT];       // calls to each operation, indexed by dyn_array_op_t
+}
+dyn_array_stats_t;
+
+///
+/// Copies out the array's statistics
+/// \param dyn_array the dynamic array
+/// \param stats destination for the statistics
+/// \return true on success, false on error or if the library was built without DYN_ARRAY_STATS
+///
+bool dyn_array_get_stats(const dyn_array_t *const dyn_array, dyn_array_stats_t *const stats);
+
+///
+/// Zeroes the array's statistics (peaks restart from the current capacity and size)
+/// \param dyn_array the dynamic array
+///
+void dyn_array_reset_stats(dyn_array_t *const dyn_array);
+
+///
+/// Returns a short lowercase name for an operation
+/// \param op the operation
+/// \return the name, NULL on error
+///
+const char *dyn_array_op_name(const dyn_array_op_t op);
+
 #ifdef __cplusplus
   }
 #endif
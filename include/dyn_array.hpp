@@ -0,0 +1,316 @@
+#ifndef DYN_ARRAY_HPP
+#define DYN_ARRAY_HPP
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#include "dyn_array.h"
+
+/*
+    C++ notes!
+
+    dyn_array_of<T> owns a plain dyn_array_t created with sizeof(T) objects, so it's the same storage
+    and get() hands it to any of the C functions. What it adds is the element size as a constant,
+    T* iterators, and sort/for_each/insert_sorted taking any callable, lambdas included, so the
+    compiler can inline the comparison instead of calling through a void* function pointer.
+
+    Reads, and writes that fit in the capacity already there, happen inline. Anything that has to
+    grow, shrink or destruct goes through the C functions, so the growth policy, allocation flags
+    and destructor all behave exactly as they do from C.
+
+    T has to be trivially copyable, the C side moves objects around with memmove and realloc.
+    Errors are reported the C way: false, NULL or an invalid (false) array, no exceptions.
+    The inline fast paths don't count towards DYN_ARRAY_STATS.
+*/
+
+template <typename T>
+class dyn_array_of
+{
+    static_assert(std::is_trivially_copyable<T>::value, "dyn_array_of moves its objects with memmove");
+
+  public:
+    typedef T value_type;
+    typedef T *iterator;
+    typedef const T *const_iterator;
+
+    ///
+    /// Creates an empty array, check it with operator bool
+    /// \param capacity initial capacity, 0 for the library default
+    /// \param allocation dyn_alloc_flags_t, see dyn_array_create_with
+    ///
+    explicit dyn_array_of(const size_t capacity = 0, const unsigned int allocation = DYN_ALLOC_DEFAULT)
+        : array_(dyn_array_create_with(capacity, sizeof(T), NULL, allocation))
+    {
+    }
+
+    ///
+    /// Takes ownership of an array from the C API
+    /// \param array the array, destroyed straight away (and the result invalid) if its objects aren't sizeof(T)
+    /// \return the wrapped array
+    ///
+    static dyn_array_of adopt(dyn_array_t *const array)
+    {
+        if (array && dyn_array_data_size(array) != sizeof(T))
+        {
+            dyn_array_destroy(array);
+            return dyn_array_of(nullptr, adopted());
+        }
+        return dyn_array_of(array, adopted());
+    }
+
+    dyn_array_of(dyn_array_of &&other) noexcept : array_(other.array_)
+    {
+        other.array_ = nullptr;
+    }
+
+    dyn_array_of &operator=(dyn_array_of &&other) noexcept
+    {
+        if (this != &other)
+        {
+            dyn_array_destroy(array_);
+            array_ = other.array_;
+            other.array_ = nullptr;
+        }
+        return *this;
+    }
+
+    dyn_array_of(const dyn_array_of &) = delete;
+    dyn_array_of &operator=(const dyn_array_of &) = delete;
+
+    ~dyn_array_of()
+    {
+        dyn_array_destroy(array_);
+    }
+
+    /// \return false if creation failed or the array was moved from or released
+    explicit operator bool() const
+    {
+        return array_ != nullptr;
+    }
+
+    /// \return the underlying array for the C API, still owned by this
+    dyn_array_t *get() const
+    {
+        return array_;
+    }
+
+    /// \return the underlying array, now owned by the caller
+    dyn_array_t *release()
+    {
+        dyn_array_t *const array = array_;
+        array_ = nullptr;
+        return array;
+    }
+
+    size_t size() const
+    {
+        return array_ ? array_->size : 0;
+    }
+
+    size_t capacity() const
+    {
+        return array_ ? array_->capacity : 0;
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    T *data() const
+    {
+        return array_ ? static_cast<T *>(array_->array) : nullptr;
+    }
+
+    iterator begin()
+    {
+        return data();
+    }
+
+    iterator end()
+    {
+        return data() + size();
+    }
+
+    const_iterator begin() const
+    {
+        return data();
+    }
+
+    const_iterator end() const
+    {
+        return data() + size();
+    }
+
+    /// Unchecked, like std::vector
+    T &operator[](const size_t index)
+    {
+        return data()[index];
+    }
+
+    const T &operator[](const size_t index) const
+    {
+        return data()[index];
+    }
+
+    /// \return pointer to the object at index, NULL if out of range
+    T *at(const size_t index) const
+    {
+        return index < size() ? data() + index : nullptr;
+    }
+
+    /// \return pointer to the first object, NULL if empty
+    T *front() const
+    {
+        return at(0);
+    }
+
+    /// \return pointer to the last object, NULL if empty
+    T *back() const
+    {
+        return empty() ? nullptr : data() + size() - 1;
+    }
+
+    ///
+    /// Copies an object onto the end, growing through dyn_array_push_back if it's full
+    /// \return bool representing success of the operation
+    ///
+    bool push_back(const T &object)
+    {
+        if (array_ && array_->size < array_->capacity)
+        {
+            std::memcpy(data() + array_->size++, &object, sizeof(T));
+            return true;
+        }
+        return array_ && dyn_array_push_back(array_, &object);
+    }
+
+    ///
+    /// Moves the last object out, without destructing it
+    /// \return bool representing success of the operation
+    ///
+    bool extract_back(T &object)
+    {
+        if (empty())
+        {
+            return false;
+        }
+        std::memcpy(&object, data() + --array_->size, sizeof(T));
+        return true;
+    }
+
+    /// Removes and optionally destructs the last object, see dyn_array_pop_back
+    bool pop_back()
+    {
+        return array_ && dyn_array_pop_back(array_);
+    }
+
+    /// Copies count objects onto the end, see dyn_array_append
+    bool append(const T *const objects, const size_t count)
+    {
+        return array_ && dyn_array_append(array_, objects, count);
+    }
+
+    /// Inserts an object before index (index == size appends), see dyn_array_insert
+    bool insert(const size_t index, const T &object)
+    {
+        if (array_ && index <= array_->size && array_->size < array_->capacity)
+        {
+            T *const position = data() + index;
+            std::memmove(position + 1, position, (array_->size - index) * sizeof(T));
+            std::memcpy(position, &object, sizeof(T));
+            ++array_->size;
+            return true;
+        }
+        return array_ && dyn_array_insert(array_, index, &object);
+    }
+
+    /// Removes and optionally destructs the object at index, see dyn_array_erase
+    bool erase(const size_t index)
+    {
+        return array_ && dyn_array_erase(array_, index);
+    }
+
+    /// Removes and optionally destructs everything, see dyn_array_clear
+    void clear()
+    {
+        if (array_)
+        {
+            dyn_array_clear(array_);
+        }
+    }
+
+    ///
+    /// Sorts with std::sort, so like dyn_array_sort equal objects end up in no particular order
+    /// \param less strict weak ordering, e.g. [](const T &a, const T &b) { return a.key < b.key; }
+    /// \return bool representing success of the operation (false when empty, as in C)
+    ///
+    template <typename Less>
+    bool sort(Less less)
+    {
+        if (empty())
+        {
+            return false;
+        }
+        std::sort(begin(), end(), less);
+        return true;
+    }
+
+    ///
+    /// Calls func on every object
+    /// \param func called as func(T &)
+    /// \return bool representing success of the operation (really just the pointer check)
+    ///
+    template <typename Func>
+    bool for_each(Func func)
+    {
+        if (!array_)
+        {
+            return false;
+        }
+        for (T &object : *this)
+        {
+            func(object);
+        }
+        return true;
+    }
+
+    /// \return index of the first object that isn't less than the given one, the size if there isn't one
+    template <typename Less>
+    size_t lower_bound(const T &object, Less less) const
+    {
+        return std::lower_bound(begin(), end(), object, less) - begin();
+    }
+
+    /// \return index of the first object the given one is less than, the size if there isn't one
+    template <typename Less>
+    size_t upper_bound(const T &object, Less less) const
+    {
+        return std::upper_bound(begin(), end(), object, less) - begin();
+    }
+
+    ///
+    /// Inserts into a sorted array ahead of any equal objects, the same place dyn_array_insert_sorted picks
+    /// \return bool representing success of the operation
+    ///
+    template <typename Less>
+    bool insert_sorted(const T &object, Less less)
+    {
+        return array_ && insert(lower_bound(object, less), object);
+    }
+
+  private:
+    struct adopted
+    {
+    };
+
+    dyn_array_of(dyn_array_t *const array, adopted) : array_(array)
+    {
+    }
+
+    dyn_array_t *array_;
+};
+
+#endif
@@ -0,0 +1,136 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Phase timing for the loaders, sorts and scheduler loops
+//
+// Code marks a phase with INSTRUMENT_SCOPE(phase), which times from that line to the end of the
+// enclosing block (early returns included) and adds the result to process-wide totals.
+// Each scope takes clock_gettime nanoseconds, the TSC on x86, and, when counters are switched on
+// and the kernel allows it, cycles/instructions/cache misses/branch misses from perf_event_open.
+// Counters are per thread, so batch workers each count their own work into the shared totals.
+//
+// Build with -DSCHED_INSTRUMENT=ON (cmake) to turn it on. Without it INSTRUMENT_SCOPE expands to
+// nothing and the hot paths carry no trace of it, the query functions still link but report zeros.
+
+#ifdef SCHED_INSTRUMENT
+#define INSTRUMENT_ENABLED 1
+#else
+#define INSTRUMENT_ENABLED 0
+#endif
+
+typedef enum
+{
+    INSTRUMENT_LOAD,        // reading traces off disk
+    INSTRUMENT_SORT,        // dyn_array_sort and the schedulers' arrival-order sorts
+    INSTRUMENT_SCHEDULE,    // scheduler main loops, from after their setup sorts to return
+    INSTRUMENT_PHASE_COUNT,
+}
+instrument_phase_t;
+
+typedef enum
+{
+    INSTRUMENT_CYCLES,
+    INSTRUMENT_INSTRUCTIONS,
+    INSTRUMENT_CACHE_MISSES,
+    INSTRUMENT_BRANCH_MISSES,
+    INSTRUMENT_COUNTER_COUNT,
+}
+instrument_counter_t;
+
+typedef struct
+{
+    uint64_t calls;
+    uint64_t nanoseconds;
+    uint64_t ticks;                                 // TSC ticks, 0 off x86
+    uint64_t counted_calls;                         // calls that had hardware counters running
+    uint64_t counters[INSTRUMENT_COUNTER_COUNT];    // summed over counted_calls
+}
+instrument_stats_t;
+
+typedef struct
+{
+    instrument_phase_t phase;
+    bool counting;
+    uint64_t nanoseconds;
+    uint64_t ticks;
+    uint64_t counters[INSTRUMENT_COUNTER_COUNT];
+}
+instrument_scope_t;
+
+///
+/// Starts timing a phase, use INSTRUMENT_SCOPE rather than calling this directly
+/// \param phase the phase being timed
+/// \return the scope to hand to instrument_end
+///
+instrument_scope_t instrument_begin(const instrument_phase_t phase);
+
+///
+/// Stops timing a scope and adds it to its phase's totals
+/// \param scope the scope from instrument_begin
+///
+void instrument_end(instrument_scope_t *const scope);
+
+///
+/// Switches hardware counters on or off for scopes started from now on (off by default)
+/// \param enabled whether to open perf counters
+/// \return true if counters are off or could be opened on this thread, false if the kernel said no
+///
+bool instrument_set_counters(const bool enabled);
+
+///
+/// Closes the calling thread's counters, if it opened any
+/// Threads that time scopes with counters on should call this before they exit, or their perf fds leak.
+/// Scopes started on the thread afterwards just open the counters again.
+///
+void instrument_thread_exit(void);
+
+///
+/// Copies out the totals for a phase
+/// \param phase the phase
+/// \param stats destination for the totals
+/// \return bool representing success of the operation
+///
+bool instrument_snapshot(const instrument_phase_t phase, instrument_stats_t *const stats);
+
+///
+/// Zeroes every phase's totals
+///
+void instrument_reset(void);
+
+///
+/// Returns a short lowercase name for a phase
+/// \param phase the phase
+/// \return the name, NULL on error
+///
+const char *instrument_phase_name(const instrument_phase_t phase);
+
+///
+/// Returns a short lowercase name for a hardware counter
+/// \param counter the counter
+/// \return the name, NULL on error
+///
+const char *instrument_counter_name(const instrument_counter_t counter);
+
+#ifdef SCHED_INSTRUMENT
+#define INSTRUMENT_CONCAT_(a, b) a##b
+#define INSTRUMENT_CONCAT(a, b) INSTRUMENT_CONCAT_(a, b)
+#define INSTRUMENT_SCOPE(phase)                                                                    \
+    instrument_scope_t INSTRUMENT_CONCAT(instrument_scope_, __LINE__)                              \
+        __attribute__((cleanup(instrument_end))) = instrument_begin(phase)
+#else
+#define INSTRUMENT_SCOPE(phase) ((void) 0)
+#endif
+
+#ifdef __cplusplus
+  }
+#endif
+
+#endif
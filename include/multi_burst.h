@@ -0,0 +1,82 @@
+#ifndef MULTI_BURST_H
+#define MULTI_BURST_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dyn_array.h"
+#include "processing_scheduling.h"
+
+    // PCBs that alternate CPU and I/O bursts
+    //
+    // The bursts don't live in the PCB, every PCB's list sits back to back in one shared pool and PCB i
+    // owns the slice between offsets i and i + 1. A list always starts and ends with a CPU burst:
+    // CPU, I/O, CPU, ..., CPU. The PCB itself keeps using remaining_burst_time for its current CPU burst.
+    typedef struct
+    {
+        dyn_array_t *offsets;   // size_t, one more than the number of PCBs, starts at 0
+        dyn_array_t *bursts;    // uint32_t burst lengths of every PCB back to back
+    }
+    BurstPool_t;
+
+    typedef struct
+    {
+        ScheduleResult_t schedule;      // waiting time is all the time spent in the ready queue, over every CPU burst
+        unsigned long cpu_bursts;       // CPU bursts run to completion
+        unsigned long io_bursts;        // I/O bursts completed
+        unsigned long cpu_busy_time;    // time the CPU spent running PCBs (including context switches)
+        unsigned long io_time;          // total time PCBs spent blocked on I/O
+        float cpu_utilization;          // cpu_busy_time over total run time
+        float average_io_in_flight;     // io_time over total run time, how many I/Os overlap on average
+    }
+    MultiBurstResult_t;
+
+    // Creates an empty burst pool
+    // \return a new pool, NULL on error
+    BurstPool_t *burst_pool_create(void);
+
+    // Releases the pool and its bursts
+    // \param pool the pool to destroy
+    void burst_pool_destroy(BurstPool_t *pool);
+
+    // Appends the burst list of the next PCB
+    // \param pool the pool
+    // \param bursts the CPU, I/O, ..., CPU burst lengths, CPU bursts must be non-zero
+    // \param count number of bursts, odd
+    // \return true if function ran successful else false for an error
+    bool burst_pool_append(BurstPool_t *pool, const uint32_t *bursts, size_t count);
+
+    // Returns the number of PCBs with a burst list in the pool
+    // \param pool the pool
+    // \return the number of burst lists, 0 on error
+    size_t burst_pool_size(const BurstPool_t *pool);
+
+    // Reads a multi-burst trace: records of uint32_t arrival, priority, burst count, then that many bursts
+    // \param input_file the file containing the trace
+    // \param pool destination for the burst pool that goes with the returned PCBs, caller destroys it
+    // \return a populated dyn_array of ProcessControlBlocks if function ran successful else NULL for an error
+    dyn_array_t *load_multi_burst_trace(const char *input_file, BurstPool_t **pool);
+
+    // Runs the PCBs through their CPU and I/O bursts on one CPU with a FIFO ready queue
+    // A PCB that finishes a CPU burst blocks for its I/O burst, I/O runs in parallel with the CPU and
+    // with other I/O, and the PCB rejoins the back of the ready queue when it completes
+    // Blocked PCBs sit in a timer wheel, so blocking and waking are O(1)
+    // Runs on a copy of the PCBs, the ready queue is only updated if the whole run succeeds
+    // \param ready queue a dyn_array of type ProcessControlBlock_t that contain be up to N elements
+    // \param pool the burst lists of the PCBs, in the same order \ref BurstPool_t
+    // \param quantum the time slice (round robin), 0 to run every CPU burst to completion (first come first serve)
+    // \param result used for multi-burst stat tracking \ref MultiBurstResult_t
+    // \return true if function ran successful else false for an error
+    bool multi_burst_schedule(dyn_array_t *ready_queue, const BurstPool_t *pool, size_t quantum,
+                              MultiBurstResult_t *result);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,79 @@
+#ifndef MULTICORE_SCHEDULING_H
+#define MULTICORE_SCHEDULING_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dyn_array.h"
+#include "processing_scheduling.h"
+
+// Upper bound on simulated CPUs, keeps the per-CPU stats inline in the result
+#define MULTICORE_MAX_CPUS 256
+
+    typedef enum
+    {
+        QUEUE_GLOBAL,       // one ready queue shared by every CPU
+        QUEUE_PER_CPU       // one ready queue per CPU, arrivals are dealt out round robin
+    }
+    QueueMode_t;
+
+    typedef enum
+    {
+        STEAL_MOST_LOADED,  // rob the CPU with the longest run queue
+        STEAL_RANDOM,       // rob a randomly chosen CPU, falling through to the next non-empty one
+        STEAL_NEIGHBOR      // rob the next non-empty CPU after the thief
+    }
+    StealPolicy_t;
+
+    typedef struct
+    {
+        size_t cpu_count;               // number of virtual CPUs (1 to MULTICORE_MAX_CPUS)
+        SchedulePolicy_t policy;        // ordering of the ready queue(s)
+        QueueMode_t queue_mode;         // shared or per-CPU ready queues
+        size_t quantum;                 // time slice, only used by POLICY_RR
+        bool work_stealing;             // idle CPUs pull work from other queues (QUEUE_PER_CPU only)
+        StealPolicy_t steal_policy;     // how a thief picks its victim
+        bool steal_half;                // take half the victim's queue instead of a single PCB
+        unsigned long switch_cost;      // time lost every time a CPU is handed to a different PCB
+        unsigned long migration_cost;   // extra time lost re-warming the cache of a PCB that moves to a different CPU
+        uint64_t steal_seed;            // seed for STEAL_RANDOM (0 picks a fixed default)
+    }
+    MulticoreConfig_t;
+
+    typedef struct
+    {
+        ScheduleResult_t schedule;                          // aggregate stats over every PCB
+        size_t cpu_count;                                   // number of valid entries in the per-CPU arrays
+        unsigned long cpu_busy_time[MULTICORE_MAX_CPUS];    // time each CPU spent running PCBs
+        float cpu_utilization[MULTICORE_MAX_CPUS];          // busy time over total run time, per CPU
+        float load_imbalance;                               // max busy time over mean busy time, minus one
+        unsigned long steals;                               // PCBs taken from another CPU's queue
+        unsigned long migrations;                           // dispatches onto a CPU other than the PCB's last one
+        unsigned long migration_time;                       // total time CPUs spent on migration_cost
+        unsigned long turnaround_p50;                       // median turnaround time
+        unsigned long turnaround_p95;                       // 95th percentile turnaround time
+        unsigned long turnaround_p99;                       // 99th percentile turnaround time
+        unsigned long turnaround_max;                       // worst turnaround time
+    }
+    MulticoreResult_t;
+
+    // Runs the requested scheduling policy over the incoming ready_queue on cpu_count virtual CPUs
+    // Per-CPU run queues are deques: the owning CPU takes from the head, thieves take from the tail
+    // Time advances from event to event (arrivals, completions, quantum expiries), not tick by tick,
+    // so cost is O(log n) per event instead of O(total burst time)
+    // \param ready queue a dyn_array of type ProcessControlBlock_t that contain be up to N elements
+    // \param config the CPU count, policy and queue layout to simulate \ref MulticoreConfig_t
+    // \param result used for aggregate and per-CPU stat tracking \ref MulticoreResult_t
+    // \return true if function ran successful else false for an error
+    bool multicore_schedule(dyn_array_t *ready_queue, const MulticoreConfig_t *config, MulticoreResult_t *result);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,93 @@
+#ifndef ONLINE_SCHEDULER_H
+#define ONLINE_SCHEDULER_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "processing_scheduling.h"
+
+    // Stateful single-CPU scheduler driven one arrival at a time instead of over a whole ready queue
+    // Typical loop: submit PCBs as they arrive, advance the clock, poll completions, snapshot stats whenever
+    // Every arrival, dispatch and completion costs O(log n) in the number of queued PCBs
+    typedef struct online_scheduler online_scheduler_t;
+
+    typedef struct
+    {
+        uint64_t job_id;                // id handed back by online_scheduler_submit
+        uint32_t burst_time;            // original burst of the pcb
+        uint32_t priority;              // priority of the pcb
+        unsigned long arrival;          // time the pcb entered the ready queue
+        unsigned long first_run;        // time the pcb was first put on the CPU
+        unsigned long completion;       // time the pcb finished
+    }
+    ScheduleCompletion_t;
+
+    typedef struct
+    {
+        ScheduleResult_t schedule;      // waiting time over started pcbs, turnaround over completed, total_run_time = clock
+        size_t submitted;               // pcbs handed to the scheduler so far
+        size_t started;                 // pcbs that have been on the CPU at least once
+        size_t completed;               // pcbs that have finished
+        size_t queued;                  // pcbs waiting in the ready queue right now
+        unsigned long busy_time;        // time the CPU spent running pcbs, including context switches
+    }
+    OnlineStats_t;
+
+    // Creates a scheduler for the given policy with its clock at 0
+    // Context switches cost whatever set_context_switch_cost was last given when the scheduler is created
+    // Like the batch schedulers only POLICY_RR and POLICY_SRTF charge and count them, the others report 0
+    // \param policy the scheduling policy \ref SchedulePolicy_t
+    // \param quantum the time slice, only used (and required non-zero) by POLICY_RR
+    // \return a new scheduler, NULL on error
+    online_scheduler_t *online_scheduler_create(SchedulePolicy_t policy, size_t quantum);
+
+    // Releases the scheduler and everything it still holds
+    // \param scheduler the scheduler to destroy
+    void online_scheduler_destroy(online_scheduler_t *scheduler);
+
+    // Hands a pcb to the scheduler, it becomes ready at pcb->arrival
+    // \param scheduler the scheduler
+    // \param pcb the pcb to copy in, its arrival must not be earlier than the current clock
+    // \param job_id optional destination for the id reported back on completion
+    // \return true if function ran successful else false for an error
+    bool online_scheduler_submit(online_scheduler_t *scheduler, const ProcessControlBlock_t *pcb, uint64_t *job_id);
+
+    // Runs the simulation forward, processing every event up to and including time
+    // \param scheduler the scheduler
+    // \param time the time to advance to, must not be earlier than the current clock
+    // \return true if function ran successful else false for an error
+    bool online_scheduler_advance(online_scheduler_t *scheduler, unsigned long time);
+
+    // Runs the simulation forward until every submitted pcb has completed
+    // \param scheduler the scheduler
+    // \return true if function ran successful else false for an error
+    bool online_scheduler_drain(online_scheduler_t *scheduler);
+
+    // Moves completions out of the scheduler, oldest first
+    // \param scheduler the scheduler
+    // \param completions destination, room for max_count entries
+    // \param max_count maximum number of completions to return
+    // \return number of completions written
+    size_t online_scheduler_poll(online_scheduler_t *scheduler, ScheduleCompletion_t *completions, size_t max_count);
+
+    // Reads the running stats without disturbing the simulation
+    // \param scheduler the scheduler
+    // \param stats destination for the snapshot \ref OnlineStats_t
+    // \return true if function ran successful else false for an error
+    bool online_scheduler_snapshot(const online_scheduler_t *scheduler, OnlineStats_t *stats);
+
+    // Returns the scheduler's clock
+    // \param scheduler the scheduler
+    // \return the current time, 0 on error
+    unsigned long online_scheduler_now(const online_scheduler_t *scheduler);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
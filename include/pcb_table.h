@@ -0,0 +1,70 @@
+#ifndef PCB_TABLE_H
+#define PCB_TABLE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dyn_array.h"
+#include "processing_scheduling.h"
+
+    // Compact working copy of a ready queue for the schedulers' hot loops
+    //
+    // ProcessControlBlock_t is 16 bytes, three of them padding after started, and it's also the on-disk
+    // record so it stays as it is. The schedulers copy the queue into 12 byte records instead, five to a
+    // cache line rather than four, with the started flags in a bitmap beside them since they're only looked
+    // at when a PCB is dispatched. Remaining bursts and started flags are copied back when a scheduler
+    // finishes, so callers see exactly what they would have from the schedulers working in place.
+
+    typedef struct
+    {
+        uint32_t remaining_burst_time;
+        uint32_t priority;
+        uint32_t arrival;
+    }
+    CompactPcb_t;
+
+    typedef struct
+    {
+        CompactPcb_t *pcbs;
+        uint64_t *started;      // bit per PCB, also the start of the table's one allocation
+        size_t count;
+    }
+    PcbTable_t;
+
+    // Copies a ready queue into a table
+    // \param table the table to fill in, left empty on failure
+    // \param ready_queue a non-empty dyn_array of ProcessControlBlock_t
+    // \return true if function ran successful else false for an error
+    bool pcb_table_load(PcbTable_t *const table, const dyn_array_t *const ready_queue);
+
+    // Copies remaining bursts and started flags back into the ready queue the table was loaded from
+    // \param table the table
+    // \param ready_queue the same ready queue, unchanged in size since the load
+    void pcb_table_store(const PcbTable_t *const table, dyn_array_t *const ready_queue);
+
+    // Frees a table's storage, fine to call on one that failed to load
+    // \param table the table
+    void pcb_table_release(PcbTable_t *const table);
+
+    // Marks a PCB as started
+    // \param table the table
+    // \param job index of the PCB
+    // \return true if it hadn't been started before
+    static inline bool pcb_table_start(PcbTable_t *const table, const size_t job)
+    {
+        const uint64_t bit = (uint64_t) 1 << (job % 64);
+        const bool first = !(table->started[job / 64] & bit);
+        table->started[job / 64] |= bit;
+        return first;
+    }
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,99 @@
+#ifndef PRIORITY_QUEUE_H
+#define PRIORITY_QUEUE_H
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dyn_array.h"
+
+// Binary min-heap keyed on a 64bit integer, stored in a dyn_array
+// Ties on key are broken by insertion order, so equal keys come out FIFO
+// (that's what lets FCFS and RR share the same queue as SJF and priority)
+
+typedef struct
+{
+    uint64_t key;    // ordering key, smallest comes out first
+    uint64_t seq;    // insertion sequence number, used to break ties
+    uint64_t value;  // user payload (usually a PCB index)
+}
+pq_entry_t;
+
+typedef struct
+{
+    dyn_array_t *heap;
+    uint64_t next_seq;
+}
+priority_queue_t;
+
+///
+/// Creates a new priority queue
+/// \param capacity Minimum capacity request (0 is fine if you have no opinion)
+/// \return new priority queue pointer, NULL on error
+///
+priority_queue_t *priority_queue_create(const size_t capacity);
+
+///
+/// Priority queue destructor
+/// \param pq the priority queue to destruct
+///
+void priority_queue_destroy(priority_queue_t *const pq);
+
+///
+/// Inserts a new entry into the queue
+/// \param pq the priority queue
+/// \param key the ordering key
+/// \param value the payload to store with the key
+/// \return bool representing success of the operation
+///
+bool priority_queue_push(priority_queue_t *const pq, const uint64_t key, const uint64_t value);
+
+///
+/// Returns a pointer to the smallest entry without removing it
+/// Pointer is invalidated by the next push or pop
+/// \param pq the priority queue
+/// \return pointer to the smallest entry, NULL on error/empty queue
+///
+const pq_entry_t *priority_queue_top(const priority_queue_t *const pq);
+
+///
+/// Removes the smallest entry and places it in the desired location
+/// \param pq the priority queue
+/// \param entry destination for the removed entry (NULL to discard)
+/// \return bool representing success of the operation
+///
+bool priority_queue_pop(priority_queue_t *const pq, pq_entry_t *const entry);
+
+///
+/// Removes the entry in the last heap slot and places it in the desired location
+/// That slot is always a leaf, so this is O(1) and never disturbs the heap order.
+/// It is not the largest entry, just one near the bottom - handy for cheap work stealing
+/// \param pq the priority queue
+/// \param entry destination for the removed entry (NULL to discard)
+/// \return bool representing success of the operation
+///
+bool priority_queue_pop_back(priority_queue_t *const pq, pq_entry_t *const entry);
+
+///
+/// Returns the number of entries in the queue
+/// \param pq the priority queue
+/// \return number of entries, 0 on error
+///
+size_t priority_queue_size(const priority_queue_t *const pq);
+
+///
+/// Tests if the queue is empty
+/// \param pq the priority queue
+/// \return true if queue is empty (or NULL was passed), false otherwise
+///
+bool priority_queue_empty(const priority_queue_t *const pq);
+
+#ifdef __cplusplus
+  }
+#endif
+
+#endif
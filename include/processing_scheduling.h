@@ -25,15 +25,92 @@ extern "C"
         float average_waiting_time;     // the average waiting time in the ready queue until first schedue on the cpu
         float average_turnaround_time;  // the average completion time of the PCBs
         unsigned long total_run_time;   // the total time to process all the PCBs in the ready queue
+        unsigned long context_switches; // times the CPU was handed from one PCB to a different one
+                                        // (a preemption, the non-preemptive schedulers report 0)
+        unsigned long switch_overhead;  // time lost to context switching, included in total_run_time
     } 
     ScheduleResult_t;
 
+    typedef enum
+    {
+        POLICY_FCFS,        // first come first served, non-preemptive
+        POLICY_SJF,         // shortest job first, non-preemptive
+        POLICY_SRTF,        // shortest remaining time first, preempts on arrival
+        POLICY_RR,          // round robin, preempts on quantum expiry
+        POLICY_PRIORITY     // lowest priority value first, non-preemptive
+    }
+    SchedulePolicy_t;       // policy selector for the simulators that run more than one algorithm
+
+    // Most levels a multilevel feedback queue can have, one bit each in the non-empty level bitmap
+    #define MLFQ_MAX_LEVELS 64
+
+    typedef struct
+    {
+        size_t levels;                          // number of priority levels, 1 to MLFQ_MAX_LEVELS (0 is the highest)
+        size_t quanta[MLFQ_MAX_LEVELS];         // time slice of each level, all non-zero
+        unsigned long boost_interval;           // every this many time units everything moves back to level 0 (0 disables)
+    }
+    MlfqConfig_t;
+
+    // Deadline of a PCB that doesn't have one, sorts after every real deadline
+    #define EDF_NO_DEADLINE UINT32_MAX
+
+    typedef struct
+    {
+        ScheduleResult_t schedule;      // aggregate stats over every PCB
+        size_t deadline_count;          // PCBs that had a deadline
+        size_t deadline_misses;         // PCBs that completed after their deadline
+        double total_lateness;          // sum of completion - deadline over the missed PCBs
+        unsigned long tardiness_p50;    // median tardiness (0 for PCBs that made it) over PCBs with a deadline
+        unsigned long tardiness_p95;    // 95th percentile tardiness
+        unsigned long tardiness_p99;    // 99th percentile tardiness
+        unsigned long tardiness_max;    // worst tardiness
+    }
+    DeadlineResult_t;
+
+    typedef struct
+    {
+        ScheduleResult_t schedule;      // aggregate stats over every PCB
+        double median_share_ratio;      // achieved over target service, median over PCBs (1.0 is exactly fair)
+                                        // PCBs with a zero burst have no ratio and are left out, 1.0 if that's all
+        double min_share_ratio;         // PCB that got the least of its fair share
+        double max_share_ratio;         // PCB that got the most over its fair share
+        double mean_absolute_lag;       // |achieved - target| service at completion, averaged over PCBs
+    }
+    ShareResult_t;                      // target is what an ideal fluid CPU split by tickets would have given each PCB
+
+    // Sets the time every preemptive single-CPU scheduler charges for handing the CPU to a different PCB
+    // (multicore_schedule takes its costs from MulticoreConfig_t instead). Defaults to 0, i.e. free switches.
+    // The non-preemptive schedulers (FCFS, SJF, priority) only change PCBs when one finishes, they charge
+    // nothing and report 0 context switches whatever the cost, so they compare like for like with each other.
+    // Each run reads the cost once when it starts, so set it before starting the schedulers it's meant for.
+    // Setting it while others run is safe but they keep the cost they started with.
+    // \param cost the fixed cost of one context switch
+    void set_context_switch_cost(unsigned long cost);
+
+    // Returns the context switch cost set by set_context_switch_cost
+    // \return the fixed cost of one context switch
+    unsigned long get_context_switch_cost(void);
+
     // Reads the PCB burst time values from the binary file into ProcessControlBlock_t remaining_burst_time field
     // for N number of PCB burst time stored in the file.
     // \param input_file the file containing the PCB burst times
     // \return a populated dyn_array of ProcessControlBlocks if function ran successful else NULL for an error
     dyn_array_t *load_process_control_blocks(const char *input_file);
 
+    // Same as load_process_control_blocks, but refills an existing ready queue in place
+    // Meant for callers loading trace after trace, the queue's storage is reused rather than reallocated
+    // \param input_file the file containing the PCB burst times
+    // \param ready_queue a dyn_array of type ProcessControlBlock_t, cleared first, left empty on error
+    // \return true if function ran successful else false for an error
+    bool load_process_control_blocks_into(const char *input_file, dyn_array_t *ready_queue);
+
+    // Reads the optional deadline trace that goes with a PCB file: one uint32_t absolute deadline per PCB,
+    // in the same order as the PCB file, EDF_NO_DEADLINE for PCBs without one
+    // \param input_file the file containing the deadlines
+    // \return a populated dyn_array of uint32_t deadlines if function ran successful else NULL for an error
+    dyn_array_t *load_process_deadlines(const char *input_file);
+
     // Runs the First Come First Served Process Scheduling algorithm over the incoming ready_queue
     // \param ready queue a dyn_array of type ProcessControlBlock_t that contain be up to N elements
     // \param result used for first come first served stat tracking \ref ScheduleResult_t
@@ -41,11 +118,21 @@ extern "C"
     bool first_come_first_serve(dyn_array_t *ready_queue, ScheduleResult_t *result);
 
     // Runs the Shortest Job First Scheduling algorithm over the incoming ready_queue
+    // Non-preemptive, shortest burst first among the PCBs that have arrived and earliest arrival among equals.
+    // No context switch cost is charged (see set_context_switch_cost). The PCBs are run where they are, the
+    // ready_queue keeps its order
     // \param ready queue a dyn_array of type ProcessControlBlock_t that contain be up to N elements
     // \param result used for shortest job first stat tracking \ref ScheduleResult_t
     // \return true if function ran successful else false for an error
     bool shortest_job_first(dyn_array_t *ready_queue, ScheduleResult_t *result);
 
+    // Shortest Job First without writing to the ready_queue, the scheduler sorts (burst, index) pairs and works
+    // on a copy of the PCBs, so one queue can be scheduled from several threads at once
+    // \param ready queue a dyn_array of type ProcessControlBlock_t that contain be up to N elements
+    // \param result used for shortest job first stat tracking \ref ScheduleResult_t
+    // \return true if function ran successful else false for an error
+    bool shortest_job_first_readonly(const dyn_array_t *ready_queue, ScheduleResult_t *result);
+
     // Runs the Priority algorithm over the incoming ready_queue
     // \param ready queue a dyn_array of type ProcessControlBlock_t that contain be up to N elements
     // \param result used for shortest job first stat tracking \ref ScheduleResult_t
@@ -60,11 +147,65 @@ extern "C"
     bool round_robin(dyn_array_t *ready_queue, ScheduleResult_t *result, size_t quantum);
 
     // Runs the Shortest Remaining Time First Process Scheduling algorithm over the incoming ready_queue
+    // An arrival with strictly less work than the running PCB has left takes the CPU. Waiting time is up to a
+    // PCB's first dispatch, as with round robin, and the ready_queue keeps its order. Being preemptive, it charges
+    // the context switch cost whenever the CPU goes to a different PCB
     // \param ready queue a dyn_array of type ProcessControlBlock_t that contain be up to N elements
     // \param result used for shortest job first stat tracking \ref ScheduleResult_t
     // \return true if function ran successful else false for an error
     bool shortest_remaining_time_first(dyn_array_t *ready_queue, ScheduleResult_t *result);
 
+    // Shortest Remaining Time First without writing to the ready_queue, see shortest_job_first_readonly
+    // \param ready queue a dyn_array of type ProcessControlBlock_t that contain be up to N elements
+    // \param result used for shortest remaining time first stat tracking \ref ScheduleResult_t
+    // \return true if function ran successful else false for an error
+    bool shortest_remaining_time_first_readonly(const dyn_array_t *ready_queue, ScheduleResult_t *result);
+
+    // Runs a Completely Fair (virtual runtime) Process Scheduling algorithm over the incoming ready_queue
+    // Each PCB's priority maps to a weight (priority p runs like nice p - 20, so lower values get more CPU),
+    // the PCB with the smallest weighted virtual runtime runs next, for its weighted share of target_latency
+    // \param ready queue a dyn_array of type ProcessControlBlock_t that contain be up to N elements
+    // \param result used for completely fair stat tracking \ref ScheduleResult_t
+    // \param target_latency the period in which every runnable PCB should get to run once
+    // \return true if function ran successful else false for an error
+    bool completely_fair_scheduler(dyn_array_t *ready_queue, ScheduleResult_t *result, size_t target_latency);
+
+    // Runs the preemptive Earliest Deadline First Process Scheduling algorithm over the incoming ready_queue
+    // The ready PCB with the earliest absolute deadline runs, an arrival with an earlier deadline preempts it
+    // \param ready queue a dyn_array of type ProcessControlBlock_t that contain be up to N elements
+    // \param deadlines a dyn_array of uint32_t deadlines matching ready_queue one to one, NULL if no PCB has one
+    // \param result used for deadline stat tracking \ref DeadlineResult_t
+    // \return true if function ran successful else false for an error
+    bool earliest_deadline_first(dyn_array_t *ready_queue, const dyn_array_t *deadlines, DeadlineResult_t *result);
+
+    // Runs the Stride Process Scheduling algorithm over the incoming ready_queue
+    // Each PCB holds priority tickets (0 counts as 1) and the lowest pass value runs next for a quantum,
+    // its pass then advancing by slice / tickets, so CPU time comes out deterministically proportional to tickets
+    // \param ready queue a dyn_array of type ProcessControlBlock_t that contain be up to N elements
+    // \param result used for proportional share stat tracking \ref ShareResult_t
+    // \param quantum the time slice
+    // \return true if function ran successful else false for an error
+    bool stride_scheduling(dyn_array_t *ready_queue, ShareResult_t *result, size_t quantum);
+
+    // Runs the Lottery Process Scheduling algorithm over the incoming ready_queue
+    // Each PCB holds priority tickets (0 counts as 1) and every quantum goes to a randomly drawn ticket,
+    // so CPU time is proportional to tickets on average
+    // \param ready queue a dyn_array of type ProcessControlBlock_t that contain be up to N elements
+    // \param result used for proportional share stat tracking \ref ShareResult_t
+    // \param quantum the time slice
+    // \param seed seed for the ticket draws (0 picks a fixed default), the same seed gives the same schedule
+    // \return true if function ran successful else false for an error
+    bool lottery_scheduling(dyn_array_t *ready_queue, ShareResult_t *result, size_t quantum, uint64_t seed);
+
+    // Runs the Multilevel Feedback Queue Process Scheduling algorithm over the incoming ready_queue
+    // New PCBs start at level 0, a PCB that uses its whole slice drops a level, a PCB at a higher level
+    // preempts a lower one, and a periodic boost puts everything back on level 0
+    // \param ready queue a dyn_array of type ProcessControlBlock_t that contain be up to N elements
+    // \param result used for multilevel feedback queue stat tracking \ref ScheduleResult_t
+    // \param config the levels, per-level quanta and boost interval \ref MlfqConfig_t
+    // \return true if function ran successful else false for an error
+    bool multilevel_feedback_queue(dyn_array_t *ready_queue, ScheduleResult_t *result, const MlfqConfig_t *config);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,89 @@
+#ifndef RB_TREE_H
+#define RB_TREE_H
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Intrusive red-black tree
+//
+// Embed an rb_node_t in your own struct and hand the tree a pointer to it, the tree never allocates.
+// Get back to your struct with RB_ENTRY. The leftmost node is cached, so finding the minimum is O(1)
+// and insert/erase are O(log n).
+// Nodes that compare equal are kept in insertion order (a new node goes after its equals).
+
+typedef struct rb_node
+{
+    struct rb_node *parent;
+    struct rb_node *left;
+    struct rb_node *right;
+    bool red;
+}
+rb_node_t;
+
+typedef struct
+{
+    rb_node_t *root;
+    rb_node_t *leftmost;
+    size_t size;
+    int (*compare)(const rb_node_t *const, const rb_node_t *const);
+}
+rb_tree_t;
+
+// Gets the struct containing an embedded node
+#define RB_ENTRY(node_ptr, type, member) ((type *) ((char *) (node_ptr) - offsetof(type, member)))
+
+///
+/// Sets up an empty tree
+/// compare(x,y) < 0 iff x < y, 0 iff x == y, > 0 iff x > y
+/// \param tree the tree to initialize
+/// \param compare the comparison function
+///
+void rb_tree_init(rb_tree_t *const tree, int (*const compare)(const rb_node_t *const, const rb_node_t *const));
+
+///
+/// Links a node into the tree
+/// The node must not already be in a tree
+/// \param tree the tree
+/// \param node the node to insert
+/// \return bool representing success of the operation
+///
+bool rb_tree_insert(rb_tree_t *const tree, rb_node_t *const node);
+
+///
+/// Unlinks a node from the tree (the node itself is left for the caller to reuse or free)
+/// \param tree the tree
+/// \param node the node to erase, must be in this tree
+/// \return bool representing success of the operation
+///
+bool rb_tree_erase(rb_tree_t *const tree, rb_node_t *const node);
+
+///
+/// Returns the smallest node
+/// \param tree the tree
+/// \return the leftmost node, NULL on error/empty tree
+///
+rb_node_t *rb_tree_first(const rb_tree_t *const tree);
+
+///
+/// Returns the in-order successor of a node
+/// \param node a node in a tree
+/// \return the next larger node, NULL if node was the largest or on error
+///
+rb_node_t *rb_tree_next(const rb_node_t *const node);
+
+///
+/// Returns the number of nodes in the tree
+/// \param tree the tree
+/// \return the number of nodes, 0 on error
+///
+size_t rb_tree_size(const rb_tree_t *const tree);
+
+#ifdef __cplusplus
+  }
+#endif
+
+#endif
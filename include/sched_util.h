@@ -0,0 +1,36 @@
+#ifndef SCHED_UTIL_H
+#define SCHED_UTIL_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+    // Small helpers shared by the scheduling library's translation units, not part of its API
+
+    // qsort comparison for uint64 keys, e.g. the (arrival << 32 | index) keys used to walk PCBs in arrival order
+    static inline int compare_u64(const void *a, const void *b)
+    {
+        const uint64_t key_a = *(const uint64_t *) a;
+        const uint64_t key_b = *(const uint64_t *) b;
+        return (key_a > key_b) - (key_a < key_b);
+    }
+
+    // Nearest-rank percentile
+    // \param sorted values in ascending order
+    // \param count number of values, at least 1
+    // \param pct the percentile, 0 to 100
+    // \return the value at that rank
+    static inline unsigned long percentile(const uint64_t *sorted, const size_t count, const unsigned int pct)
+    {
+        const size_t rank = (count * pct + 99) / 100;
+        return (unsigned long) sorted[rank ? rank - 1 : 0];
+    }
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,58 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Fork-join thread pool, for splitting one big pass into tasks and waiting for them all
+//
+// The workers are started once and sleep between runs, so a pool can be kept around and reused
+// for pass after pass without paying for thread creation each time.
+// The thread calling thread_pool_run works through tasks alongside the workers, so a pool of size n
+// has n - 1 worker threads. Runs from different threads take turns, a task must not start
+// another run on its own pool.
+
+typedef struct thread_pool thread_pool_t;
+
+///
+/// Creates a pool and starts its workers
+/// If some workers can't be started the pool just ends up smaller, see thread_pool_size
+/// \param threads number of threads to run tasks on, counting the caller, 0 for one per online CPU
+/// \return new pool pointer, NULL on error
+///
+thread_pool_t *thread_pool_create(const size_t threads);
+
+///
+/// Stops the workers and frees the pool, must not race with a run
+/// \param pool the pool to destruct
+///
+void thread_pool_destroy(thread_pool_t *const pool);
+
+///
+/// Returns how many threads run tasks, the caller included
+/// \param pool the pool
+/// \return the pool's size, 1 on error (a missing pool still has the caller)
+///
+size_t thread_pool_size(const thread_pool_t *const pool);
+
+///
+/// Runs task(index, arg) for every index in [0, tasks) and waits for them all to finish
+/// Tasks are handed out in index order to whichever thread is free, each exactly once
+/// \param pool the pool
+/// \param task the task function
+/// \param arg argument that will be passed to every task (as parameter 2)
+/// \param tasks number of tasks
+/// \return bool representing success of the operation (really just pointer checks)
+///
+bool thread_pool_run(thread_pool_t *const pool, void (*const task)(const size_t, void *), void *arg,
+                     const size_t tasks);
+
+#ifdef __cplusplus
+  }
+#endif
+
+#endif
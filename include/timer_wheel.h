@@ -0,0 +1,108 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#ifdef __cplusplus
+  extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dyn_array.h"
+
+// Hierarchical timing wheel: a time-ordered event queue for simulators with lots of pending timers
+//
+// Eleven levels of 64 slots cover the whole 64bit time range, level L slots are 64^L ticks wide.
+// A timer goes in the coarsest level it needs and moves down a level when the clock enters its slot,
+// so insert and cancel are O(1) and popping is amortized O(1) (each timer cascades at most once per level).
+// Timers come out in expiry order, equal expiries in insertion order, same as priority_queue_t.
+// Timer storage is a dyn_array of nodes recycled through a free list, the wheel never allocates per timer.
+// multicore_schedule keeps a completion timer per CPU in one, multi_burst_schedule its PCBs blocked on I/O.
+
+#define TIMER_WHEEL_LEVEL_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_LEVEL_BITS)
+#define TIMER_WHEEL_LEVELS 11
+
+typedef struct
+{
+    uint32_t head[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];   // first node in each slot, FIFO order
+    uint32_t tail[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];   // last node in each slot
+    uint64_t occupied[TIMER_WHEEL_LEVELS];                  // bit per non-empty slot
+    dyn_array_t *nodes;                                     // timer storage, indexed by the low half of an id
+    uint32_t free_list;                                     // recycled nodes
+    uint64_t now;                                           // wheel clock, never past the next expiry
+    size_t size;
+}
+timer_wheel_t;
+
+///
+/// Creates a new timer wheel
+/// \param start_time the initial clock, no timer may expire before it
+/// \param capacity Minimum number of timers to make room for (0 is fine if you have no opinion)
+/// \return new timer wheel pointer, NULL on error
+///
+timer_wheel_t *timer_wheel_create(const uint64_t start_time, const size_t capacity);
+
+///
+/// Timer wheel destructor
+/// \param wheel the timer wheel to destruct
+///
+void timer_wheel_destroy(timer_wheel_t *const wheel);
+
+///
+/// Schedules a timer
+/// \param wheel the timer wheel
+/// \param expiry the time the timer fires, not before timer_wheel_now
+/// \param value the payload handed back when the timer fires (usually a PCB index)
+/// \param id optional destination for a handle to cancel the timer with
+/// \return bool representing success of the operation
+///
+bool timer_wheel_insert(timer_wheel_t *const wheel, const uint64_t expiry, const uint64_t value, uint64_t *const id);
+
+///
+/// Cancels a pending timer
+/// \param wheel the timer wheel
+/// \param id the handle from timer_wheel_insert
+/// \return true if the timer was pending, false if it already fired, was cancelled, or on error
+///
+bool timer_wheel_cancel(timer_wheel_t *const wheel, const uint64_t id);
+
+///
+/// Removes the earliest timer if it fires at or before until, moving the clock to its expiry
+/// If nothing fires by until the clock may still move forward, but never past until
+/// \param wheel the timer wheel
+/// \param until latest expiry to accept
+/// \param expiry optional destination for the timer's expiry
+/// \param value optional destination for the timer's payload
+/// \return true if a timer was removed, false if none fires by until or on error
+///
+bool timer_wheel_pop(timer_wheel_t *const wheel, const uint64_t until, uint64_t *const expiry, uint64_t *const value);
+
+///
+/// Looks up the earliest expiry without removing anything or moving the clock
+/// \param wheel the timer wheel
+/// \param expiry destination for the earliest expiry
+/// \return true if there is a pending timer, false if the wheel is empty or on error
+///
+bool timer_wheel_peek(const timer_wheel_t *const wheel, uint64_t *const expiry);
+
+///
+/// Returns the wheel clock, a lower bound on every pending expiry
+/// \param wheel the timer wheel
+/// \return the clock, 0 on error
+///
+uint64_t timer_wheel_now(const timer_wheel_t *const wheel);
+
+///
+/// Returns the number of pending timers
+/// \param wheel the timer wheel
+/// \return the number of timers, 0 on error
+///
+size_t timer_wheel_size(const timer_wheel_t *const wheel);
+
+#ifdef __cplusplus
+  }
+#endif
+
+#endif
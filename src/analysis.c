@@ -1,90 +1,883 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <dirent.h>
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
 
 #include "dyn_array.h"
+#include "instrumentation.h"
 #include "processing_scheduling.h"
 
 #define FCFS "FCFS"
 #define P "P"
 #define RR "RR"
 #define SJF "SJF"
+#define CFS "CFS"
+#define EDF "EDF"
+#define STRIDE "STRIDE"
+#define LOTTERY "LOTTERY"
+
+#define BATCH_OPTION "--batch"
+#define JOBS_OPTION "--jobs="
+#define FORMAT_OPTION "--format="
+#define COUNTERS_OPTION "--counters"
+
+static double seconds_between(const struct timespec *start, const struct timespec *end)
+{
+    return (double) (end->tv_sec - start->tv_sec) + (double) (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Everything one run produces, the deadline and share stats only come from the algorithms that have them
+typedef struct
+{
+    ScheduleResult_t schedule;
+    DeadlineResult_t deadline;
+    ShareResult_t share;
+    bool has_deadline;
+    bool has_share;
+}
+RunResult_t;
+
+// One trace's run and what it cost, batch rows are filled in by whichever worker picks them up
+typedef struct
+{
+    const char *trace;
+    size_t job_count;
+    bool success;
+    RunResult_t result;
+    double load_seconds;
+    double schedule_seconds;
+    dyn_array_stats_t queue_stats;  // the ready queue's, single runs of a DYN_ARRAY_STATS build only
+    bool has_queue_stats;
+}
+RunRecord_t;
+
+typedef enum
+{
+    FORMAT_TEXT,
+    FORMAT_CSV,
+    FORMAT_JSON,
+    FORMAT_BINARY,
+}
+OutputFormat_t;
+
+// --format=binary: BINARY_MAGIC, a uint32_t version and a uint32_t record count, then every record as a
+// BinaryRecord_t followed by name_length bytes of trace name (no terminator), all in native byte order
+#define BINARY_MAGIC "SCHEDRES"
+#define BINARY_VERSION 1
+
+typedef struct
+{
+    uint64_t total_run_time;
+    uint64_t context_switches;
+    uint64_t switch_overhead;
+    double load_seconds;
+    double schedule_seconds;
+    double jobs_per_second;
+    float average_waiting_time;
+    float average_turnaround_time;
+    uint32_t job_count;
+    uint32_t success;
+    uint32_t name_length;
+    uint32_t reserved;
+}
+BinaryRecord_t;
+
+_Static_assert(sizeof(BinaryRecord_t) == 72, "binary records are read back by other tools, no padding allowed");
 
-int main(int argc, char **argv) 
+typedef struct
 {
-    if (argc < 3) 
+    RunRecord_t *rows;
+    size_t row_count;
+    atomic_size_t next_row;     // workers claim rows off this one at a time
+    const char *algorithm;
+    size_t quantum;
+}
+Batch_t;
+
+static bool valid_algorithm(const char *algorithm)
+{
+    const char *const algorithms[] = { FCFS, SJF, RR, P, CFS, EDF, STRIDE, LOTTERY };
+    for (size_t i = 0; i < sizeof(algorithms) / sizeof(algorithms[0]); ++i)
     {
-        printf("%s <pcb file> <schedule algorithm> [quantum]\n", argv[0]);
-        return EXIT_FAILURE;
+        if (strcmp(algorithm, algorithms[i]) == 0)
+        {
+            return true;
+        }
     }
+    return false;
+}
 
-    const char *pcb_file = argv[1];
-    const char *algorithm = argv[2];
-    size_t quantum = 0;
+// Runs one (valid) algorithm over the ready queue
+// \param deadlines the EDF deadline trace, NULL if there isn't one
+static bool run_algorithm(const char *algorithm, dyn_array_t *ready_queue, size_t quantum,
+                          const dyn_array_t *deadlines, RunResult_t *result)
+{
+    result->has_deadline = false;
+    result->has_share = false;
 
-    if (argc == 4) 
+    if (strcmp(algorithm, FCFS) == 0)
     {
-        quantum = atoi(argv[3]);
+        return first_come_first_serve(ready_queue, &result->schedule);
+    }
+    if (strcmp(algorithm, SJF) == 0)
+    {
+        return shortest_job_first(ready_queue, &result->schedule);
+    }
+    if (strcmp(algorithm, RR) == 0)
+    {
+        return round_robin(ready_queue, &result->schedule, quantum);
+    }
+    if (strcmp(algorithm, P) == 0)
+    {
+        return priority(ready_queue, &result->schedule);
+    }
+    if (strcmp(algorithm, CFS) == 0)
+    {
+        // the quantum argument is the target latency for CFS
+        return completely_fair_scheduler(ready_queue, &result->schedule, quantum);
+    }
+    if (strcmp(algorithm, EDF) == 0)
+    {
+        if (!earliest_deadline_first(ready_queue, deadlines, &result->deadline))
+        {
+            return false;
+        }
+        result->schedule = result->deadline.schedule;
+        result->has_deadline = true;
+        return true;
     }
 
-    dyn_array_t *ready_queue = load_process_control_blocks(pcb_file);
+    bool success = strcmp(algorithm, STRIDE) == 0 ? stride_scheduling(ready_queue, &result->share, quantum)
+                                                   : lottery_scheduling(ready_queue, &result->share, quantum, 0);
+    if (!success)
+    {
+        return false;
+    }
+    result->schedule = result->share.schedule;
+    result->has_share = true;
+    return true;
+}
 
-    if (ready_queue == NULL) 
+static void free_trace_name(void *trace)
+{
+    free(*(char **) trace);
+}
+
+static int compare_trace_names(const void *a, const void *b)
+{
+    return strcmp(*(char *const *) a, *(char *const *) b);
+}
+
+static bool add_trace_name(dyn_array_t *traces, const char *directory, const char *name)
+{
+    size_t length = strlen(name) + 1;
+    if (directory)
     {
-        printf("Failed to load process control blocks.\n");
-        return EXIT_FAILURE;
+        length += strlen(directory) + 1;
+    }
+    char *trace = malloc(length);
+    if (!trace)
+    {
+        return false;
+    }
+    if (directory)
+    {
+        snprintf(trace, length, "%s/%s", directory, name);
     }
+    else
+    {
+        memcpy(trace, name, length);
+    }
+    if (!dyn_array_push_back(traces, &trace))
+    {
+        free(trace);
+        return false;
+    }
+    return true;
+}
 
-    ScheduleResult_t result;
+// Every regular file in the directory, in name order so reports line up from run to run
+static bool list_directory(const char *directory, dyn_array_t *traces)
+{
+    DIR *dir = opendir(directory);
+    if (!dir)
+    {
+        return false;
+    }
 
-    if (strcmp(algorithm, FCFS) == 0) 
+    bool success = true;
+    struct dirent *entry;
+    while (success && (entry = readdir(dir)) != NULL)
     {
-        if (!first_come_first_serve(ready_queue, &result)) 
+        if (entry->d_name[0] == '.')
         {
-            printf("Failed to execute FCFS algorithm.\n");
-            dyn_array_destroy(ready_queue);
-            return EXIT_FAILURE;
+            continue;
         }
-    } 
-    else if (strcmp(algorithm, SJF) == 0) 
+        success = add_trace_name(traces, directory, entry->d_name);
+
+        // subdirectories and the like don't count, popping frees the name
+        struct stat info;
+        if (success && (stat(*(char **) dyn_array_back(traces), &info) != 0 || !S_ISREG(info.st_mode)))
+        {
+            dyn_array_pop_back(traces);
+        }
+    }
+    closedir(dir);
+    return success && dyn_array_sort(traces, compare_trace_names);
+}
+
+// One trace per line, blank lines and # comments skipped, kept in manifest order
+static bool read_manifest(const char *manifest, dyn_array_t *traces)
+{
+    FILE *file = fopen(manifest, "r");
+    if (!file)
     {
-        if (!shortest_job_first(ready_queue, &result)) 
+        return false;
+    }
+
+    bool success = true;
+    char *line = NULL;
+    size_t line_capacity = 0;
+    ssize_t length;
+    while (success && (length = getline(&line, &line_capacity, file)) >= 0)
+    {
+        while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r'))
         {
-            printf("Failed to execute SJF algorithm.\n");
-            dyn_array_destroy(ready_queue);
-            return EXIT_FAILURE;
+            line[--length] = '\0';
+        }
+        if (length > 0 && line[0] != '#')
+        {
+            success = add_trace_name(traces, NULL, line);
         }
-    } 
-    else if (strcmp(algorithm, RR) == 0) 
+    }
+    free(line);
+    fclose(file);
+    return success;
+}
+
+// Each worker keeps one ready queue for its whole share of the batch, so loading a trace reuses the
+// storage the last one left behind rather than going back to malloc
+static void *batch_worker(void *arg)
+{
+    Batch_t *batch = arg;
+    // Created and refilled on this thread, first touch keeps it on this worker's NUMA node
+    dyn_array_t *ready_queue = dyn_array_create_with(0, sizeof(ProcessControlBlock_t), NULL,
+                                                     DYN_ALLOC_HUGE_PAGES | DYN_ALLOC_FIRST_TOUCH);
+
+    size_t row_index;
+    while ((row_index = atomic_fetch_add(&batch->next_row, 1)) < batch->row_count)
     {
-        if (!round_robin(ready_queue, &result, quantum)) 
+        RunRecord_t *row = &batch->rows[row_index];
+        struct timespec start, loaded, scheduled;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        row->success = ready_queue && load_process_control_blocks_into(row->trace, ready_queue);
+        row->job_count = dyn_array_size(ready_queue);
+        clock_gettime(CLOCK_MONOTONIC, &loaded);
+        row->success = row->success
+                       && run_algorithm(batch->algorithm, ready_queue, batch->quantum, NULL, &row->result);
+        clock_gettime(CLOCK_MONOTONIC, &scheduled);
+        row->load_seconds = seconds_between(&start, &loaded);
+        row->schedule_seconds = seconds_between(&loaded, &scheduled);
+    }
+
+    dyn_array_destroy(ready_queue);
+    instrument_thread_exit();
+    return NULL;
+}
+
+static double jobs_per_second(const RunRecord_t *record)
+{
+    return record->schedule_seconds > 0 ? (double) record->job_count / record->schedule_seconds : 0.0;
+}
+
+// JSON string body, traces are file names so quotes and backslashes are all that need escaping
+static void write_json_string(FILE *out, const char *text)
+{
+    fputc('"', out);
+    for (; *text; ++text)
+    {
+        if (*text == '"' || *text == '\\')
         {
-            printf("Failed to execute RR algorithm.\n");
-            dyn_array_destroy(ready_queue);
-            return EXIT_FAILURE;
+            fputc('\\', out);
         }
-    } 
-    else if (strcmp(algorithm, P) == 0) 
+        fputc(*text, out);
+    }
+    fputc('"', out);
+}
+
+// JSON has no NaN or infinity, those go out as null
+static void write_json_double(FILE *out, const int digits, const double value)
+{
+    if (isfinite(value))
+    {
+        fprintf(out, "%.*g", digits, value);
+    }
+    else
     {
-        if (!priority(ready_queue, &result)) 
+        fprintf(out, "null");
+    }
+}
+
+// Quoted only when it has to be, with embedded quotes doubled, so any path survives as one CSV field
+static void write_csv_string(FILE *out, const char *text)
+{
+    if (!strpbrk(text, ",\"\r\n"))
+    {
+        fputs(text, out);
+        return;
+    }
+    fputc('"', out);
+    for (; *text; ++text)
+    {
+        if (*text == '"')
         {
-            printf("Failed to execute Priority algorithm.\n");
-            dyn_array_destroy(ready_queue);
-            return EXIT_FAILURE;
+            fputc('"', out);
         }
-    } 
-    else 
+        fputc(*text, out);
+    }
+    fputc('"', out);
+}
+
+static void write_text(FILE *out, const RunRecord_t *record)
+{
+    const RunResult_t *result = &record->result;
+    if (result->has_deadline)
+    {
+        const DeadlineResult_t *deadline = &result->deadline;
+        fprintf(out, "Deadline Misses: %zu of %zu\n", deadline->deadline_misses, deadline->deadline_count);
+        fprintf(out, "Total Lateness: %.0f\n", deadline->total_lateness);
+        fprintf(out, "Tardiness p50/p95/p99/max: %lu/%lu/%lu/%lu\n", deadline->tardiness_p50,
+                deadline->tardiness_p95, deadline->tardiness_p99, deadline->tardiness_max);
+    }
+    if (result->has_share)
+    {
+        const ShareResult_t *share = &result->share;
+        fprintf(out, "Achieved/Target Share median/min/max: %.3f/%.3f/%.3f\n", share->median_share_ratio,
+                share->min_share_ratio, share->max_share_ratio);
+        fprintf(out, "Mean Absolute Lag: %.2f\n", share->mean_absolute_lag);
+    }
+
+    fprintf(out, "Average Waiting Time: %.2f\n", result->schedule.average_waiting_time);
+    fprintf(out, "Average Turnaround Time: %.2f\n", result->schedule.average_turnaround_time);
+    fprintf(out, "Total Clock Time: %lu\n", result->schedule.total_run_time);
+    fprintf(out, "Context Switches: %lu (%lu overhead)\n", result->schedule.context_switches,
+            result->schedule.switch_overhead);
+}
+
+// Where the time went, only when the libraries were built with SCHED_INSTRUMENT
+static void write_phases_text(FILE *out)
+{
+    for (size_t phase = 0; phase < INSTRUMENT_PHASE_COUNT; ++phase)
+    {
+        instrument_stats_t stats;
+        instrument_snapshot((instrument_phase_t) phase, &stats);
+        fprintf(out, "Phase %s: %lu calls, %.6fs, %lu ticks", instrument_phase_name((instrument_phase_t) phase),
+                (unsigned long) stats.calls, stats.nanoseconds / 1e9, (unsigned long) stats.ticks);
+        for (size_t i = 0; stats.counted_calls && i < INSTRUMENT_COUNTER_COUNT; ++i)
+        {
+            fprintf(out, ", %lu %s", (unsigned long) stats.counters[i],
+                    instrument_counter_name((instrument_counter_t) i));
+        }
+        fputc('\n', out);
+    }
+}
+
+static void write_phases_json(FILE *out)
+{
+    fprintf(out, ",\"phases\":{");
+    for (size_t phase = 0; phase < INSTRUMENT_PHASE_COUNT; ++phase)
+    {
+        instrument_stats_t stats;
+        instrument_snapshot((instrument_phase_t) phase, &stats);
+        fprintf(out, "%s\"%s\":{\"calls\":%lu,\"nanoseconds\":%lu,\"ticks\":%lu,\"counted_calls\":%lu",
+                phase ? "," : "", instrument_phase_name((instrument_phase_t) phase), (unsigned long) stats.calls,
+                (unsigned long) stats.nanoseconds, (unsigned long) stats.ticks, (unsigned long) stats.counted_calls);
+        for (size_t i = 0; i < INSTRUMENT_COUNTER_COUNT; ++i)
+        {
+            fprintf(out, ",\"%s\":%lu", instrument_counter_name((instrument_counter_t) i),
+                    (unsigned long) stats.counters[i]);
+        }
+        fputc('}', out);
+    }
+    fputc('}', out);
+}
+
+// What the scheduler did to the ready queue, bytes moved far beyond the op counts means something went quadratic
+static void write_queue_stats_text(FILE *out, const dyn_array_stats_t *stats)
+{
+    fprintf(out, "Ready Queue: %zu reallocs (%zu bytes), %zu bytes moved, peak %zu of %zu capacity\n",
+            stats->reallocs, stats->bytes_reallocated, stats->bytes_moved, stats->peak_size, stats->peak_capacity);
+    fprintf(out, "Ready Queue Ops:");
+    for (size_t op = 0; op < DYN_OP_COUNT; ++op)
+    {
+        if (stats->ops[op])
+        {
+            fprintf(out, " %s=%zu", dyn_array_op_name((dyn_array_op_t) op), stats->ops[op]);
+        }
+    }
+    fputc('\n', out);
+}
+
+static void write_csv_header(FILE *out)
+{
+    fprintf(out, "trace,success,jobs,average_waiting_time,average_turnaround_time,total_run_time,"
+                 "context_switches,switch_overhead,load_seconds,schedule_seconds,jobs_per_second\n");
+}
+
+// Averages go out with %.9g, enough digits that a float survives the round trip through text
+static void write_csv_row(FILE *out, const RunRecord_t *record)
+{
+    const ScheduleResult_t *schedule = &record->result.schedule;
+    write_csv_string(out, record->trace);
+    fprintf(out, ",%d,%zu,", record->success, record->job_count);
+    if (record->success)
+    {
+        fprintf(out, "%.9g,%.9g,%lu,%lu,%lu,", schedule->average_waiting_time, schedule->average_turnaround_time,
+                schedule->total_run_time, schedule->context_switches, schedule->switch_overhead);
+    }
+    else
+    {
+        fprintf(out, ",,,,,");
+    }
+    fprintf(out, "%.9f,%.9f,%.1f\n", record->load_seconds, record->schedule_seconds, jobs_per_second(record));
+}
+
+static void write_json_record(FILE *out, const RunRecord_t *record)
+{
+    const RunResult_t *result = &record->result;
+    fprintf(out, "{\"trace\":");
+    write_json_string(out, record->trace);
+    fprintf(out, ",\"success\":%s,\"jobs\":%zu,\"load_seconds\":%.9f,\"schedule_seconds\":%.9f,"
+                 "\"jobs_per_second\":%.1f",
+            record->success ? "true" : "false", record->job_count, record->load_seconds, record->schedule_seconds,
+            jobs_per_second(record));
+    if (record->success)
+    {
+        fprintf(out, ",\"average_waiting_time\":");
+        write_json_double(out, 9, result->schedule.average_waiting_time);
+        fprintf(out, ",\"average_turnaround_time\":");
+        write_json_double(out, 9, result->schedule.average_turnaround_time);
+        fprintf(out, ",\"total_run_time\":%lu,\"context_switches\":%lu,\"switch_overhead\":%lu",
+                result->schedule.total_run_time, result->schedule.context_switches,
+                result->schedule.switch_overhead);
+    }
+    if (record->success && result->has_deadline)
+    {
+        const DeadlineResult_t *deadline = &result->deadline;
+        fprintf(out, ",\"deadline\":{\"count\":%zu,\"misses\":%zu,\"total_lateness\":", deadline->deadline_count,
+                deadline->deadline_misses);
+        write_json_double(out, 17, deadline->total_lateness);
+        fprintf(out, ",\"tardiness_p50\":%lu,\"tardiness_p95\":%lu,\"tardiness_p99\":%lu,\"tardiness_max\":%lu}",
+                deadline->tardiness_p50, deadline->tardiness_p95, deadline->tardiness_p99, deadline->tardiness_max);
+    }
+    if (record->success && result->has_share)
+    {
+        const ShareResult_t *share = &result->share;
+        fprintf(out, ",\"share\":{\"median_ratio\":");
+        write_json_double(out, 17, share->median_share_ratio);
+        fprintf(out, ",\"min_ratio\":");
+        write_json_double(out, 17, share->min_share_ratio);
+        fprintf(out, ",\"max_ratio\":");
+        write_json_double(out, 17, share->max_share_ratio);
+        fprintf(out, ",\"mean_absolute_lag\":");
+        write_json_double(out, 17, share->mean_absolute_lag);
+        fputc('}', out);
+    }
+    fputc('}', out);
+}
+
+static void write_binary_header(FILE *out, const size_t record_count)
+{
+    const uint32_t header[2] = { BINARY_VERSION, (uint32_t) record_count };
+    fwrite(BINARY_MAGIC, 1, strlen(BINARY_MAGIC), out);
+    fwrite(header, sizeof(header), 1, out);
+}
+
+static void write_binary_record(FILE *out, const RunRecord_t *record)
+{
+    const ScheduleResult_t *schedule = &record->result.schedule;
+    const BinaryRecord_t binary = {
+        .total_run_time = record->success ? schedule->total_run_time : 0,
+        .context_switches = record->success ? schedule->context_switches : 0,
+        .switch_overhead = record->success ? schedule->switch_overhead : 0,
+        .load_seconds = record->load_seconds,
+        .schedule_seconds = record->schedule_seconds,
+        .jobs_per_second = jobs_per_second(record),
+        .average_waiting_time = record->success ? schedule->average_waiting_time : 0,
+        .average_turnaround_time = record->success ? schedule->average_turnaround_time : 0,
+        .job_count = (uint32_t) record->job_count,
+        .success = record->success,
+        .name_length = (uint32_t) strlen(record->trace),
+        .reserved = 0,
+    };
+    fwrite(&binary, sizeof(binary), 1, out);
+    fwrite(record->trace, 1, binary.name_length, out);
+}
+
+static void write_batch_json(FILE *out, const Batch_t *batch, size_t worker_count, double elapsed)
+{
+    // Job-weighted means over the traces that ran
+    size_t traces_run = 0;
+    size_t jobs_run = 0;
+    double total_waiting = 0;
+    double total_turnaround = 0;
+    for (size_t i = 0; i < batch->row_count; ++i)
+    {
+        const RunRecord_t *row = &batch->rows[i];
+        if (row->success)
+        {
+            ++traces_run;
+            jobs_run += row->job_count;
+            total_waiting += (double) row->result.schedule.average_waiting_time * row->job_count;
+            total_turnaround += (double) row->result.schedule.average_turnaround_time * row->job_count;
+        }
+    }
+
+    fprintf(out, "{\"algorithm\":");
+    write_json_string(out, batch->algorithm);
+    fprintf(out, ",\"quantum\":%zu,\"workers\":%zu,\"elapsed_seconds\":%.9f,", batch->quantum, worker_count,
+            elapsed);
+    fprintf(out, "\"summary\":{\"traces\":%zu,\"failed\":%zu,\"jobs\":%zu,\"jobs_per_second\":%.1f,"
+                 "\"average_waiting_time\":",
+            batch->row_count, batch->row_count - traces_run, jobs_run, elapsed > 0 ? jobs_run / elapsed : 0.0);
+    write_json_double(out, 17, jobs_run ? total_waiting / jobs_run : 0.0);
+    fprintf(out, ",\"average_turnaround_time\":");
+    write_json_double(out, 17, jobs_run ? total_turnaround / jobs_run : 0.0);
+    fprintf(out, "},\"traces\":[");
+    for (size_t i = 0; i < batch->row_count; ++i)
+    {
+        if (i)
+        {
+            fputc(',', out);
+        }
+        write_json_record(out, &batch->rows[i]);
+    }
+    fputc(']', out);
+    if (INSTRUMENT_ENABLED)
+    {
+        write_phases_json(out);
+    }
+    fprintf(out, "}\n");
+}
+
+// The whole report is built in memory and handed to write() in one go, so runs don't pay per-line
+// stdio flushes. That doesn't make it atomic: with several processes on the same pipe only a report of
+// up to PIPE_BUF bytes is sure to stay in one piece, anything longer or a short write can interleave
+static bool flush_report(FILE *report, char **buffer, size_t *length)
+{
+    if (fclose(report) != 0)
+    {
+        return false;
+    }
+    size_t written = 0;
+    while (written < *length)
+    {
+        ssize_t chunk = write(STDOUT_FILENO, *buffer + written, *length - written);
+        if (chunk < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (chunk <= 0)
+        {
+            break;
+        }
+        written += (size_t) chunk;
+    }
+    free(*buffer);
+    return written == *length;
+}
+
+// Runs every trace in a directory or manifest across a fixed pool of worker threads and writes one report
+static int run_batch(const char *source, const char *algorithm, size_t quantum, size_t worker_count,
+                     OutputFormat_t format)
+{
+    dyn_array_t *traces = dyn_array_create(0, sizeof(char *), free_trace_name);
+    struct stat info;
+    bool listed = traces && stat(source, &info) == 0
+                  && (S_ISDIR(info.st_mode) ? list_directory(source, traces) : read_manifest(source, traces));
+    if (!listed || dyn_array_empty(traces))
+    {
+        printf("Failed to find any traces in %s.\n", source);
+        dyn_array_destroy(traces);
+        return EXIT_FAILURE;
+    }
+
+    Batch_t batch;
+    batch.row_count = dyn_array_size(traces);
+    batch.rows = calloc(batch.row_count, sizeof(RunRecord_t));
+    batch.algorithm = algorithm;
+    batch.quantum = quantum;
+    atomic_init(&batch.next_row, 0);
+    if (worker_count > batch.row_count)
+    {
+        worker_count = batch.row_count;
+    }
+    pthread_t *workers = malloc(worker_count * sizeof(pthread_t));
+    if (!batch.rows || !workers)
+    {
+        printf("Failed to allocate the batch.\n");
+        free(workers);
+        free(batch.rows);
+        dyn_array_destroy(traces);
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < batch.row_count; ++i)
+    {
+        batch.rows[i].trace = *(char **) dyn_array_at(traces, i);
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    size_t started = 0;
+    while (started < worker_count && pthread_create(&workers[started], NULL, batch_worker, &batch) == 0)
+    {
+        ++started;
+    }
+    if (started == 0)
+    {
+        // no threads to be had, this thread can still get through the batch on its own
+        batch_worker(&batch);
+    }
+    for (size_t i = 0; i < started; ++i)
+    {
+        pthread_join(workers[i], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    const double elapsed = seconds_between(&start, &end);
+
+    size_t failed = 0;
+    for (size_t i = 0; i < batch.row_count; ++i)
+    {
+        failed += !batch.rows[i].success;
+    }
+
+    char *buffer = NULL;
+    size_t length = 0;
+    FILE *report = open_memstream(&buffer, &length);
+    bool reported = report != NULL;
+    if (reported)
+    {
+        if (format == FORMAT_JSON)
+        {
+            write_batch_json(report, &batch, started ? started : 1, elapsed);
+        }
+        else if (format == FORMAT_BINARY)
+        {
+            write_binary_header(report, batch.row_count);
+            for (size_t i = 0; i < batch.row_count; ++i)
+            {
+                write_binary_record(report, &batch.rows[i]);
+            }
+        }
+        else
+        {
+            write_csv_header(report);
+            for (size_t i = 0; i < batch.row_count; ++i)
+            {
+                write_csv_row(report, &batch.rows[i]);
+            }
+        }
+        reported = flush_report(report, &buffer, &length);
+    }
+    fprintf(stderr, "Ran %zu traces (%zu failed) on %zu workers in %.3fs\n", batch.row_count, failed,
+            started ? started : 1, elapsed);
+
+    free(workers);
+    free(batch.rows);
+    dyn_array_destroy(traces);
+    return failed || !reported ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+static bool parse_format(const char *name, OutputFormat_t *format)
+{
+    const char *const names[] = { "text", "csv", "json", "binary" };
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i)
+    {
+        if (strcmp(name, names[i]) == 0)
+        {
+            *format = (OutputFormat_t) i;
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char **argv)
+{
+    // Options can go anywhere, everything else is positional
+    bool batch = false;
+    bool format_given = false;
+    bool counters = false;
+    OutputFormat_t format = FORMAT_TEXT;
+    long worker_count = sysconf(_SC_NPROCESSORS_ONLN);
+    const char *positional[4] = { NULL, NULL, NULL, NULL };
+    int positional_count = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], BATCH_OPTION) == 0)
+        {
+            batch = true;
+        }
+        else if (strncmp(argv[i], JOBS_OPTION, strlen(JOBS_OPTION)) == 0)
+        {
+            worker_count = atol(argv[i] + strlen(JOBS_OPTION));
+        }
+        else if (strncmp(argv[i], FORMAT_OPTION, strlen(FORMAT_OPTION)) == 0)
+        {
+            if (!parse_format(argv[i] + strlen(FORMAT_OPTION), &format))
+            {
+                printf("Invalid output format, expected text, csv, json or binary.\n");
+                return EXIT_FAILURE;
+            }
+            format_given = true;
+        }
+        else if (strcmp(argv[i], COUNTERS_OPTION) == 0)
+        {
+            counters = true;
+        }
+        else if (positional_count < 4)
+        {
+            positional[positional_count++] = argv[i];
+        }
+    }
+
+    if (positional_count < 2)
+    {
+        printf("%s <pcb file> <schedule algorithm> [quantum | deadline file] [switch cost] "
+               "[--format=text|csv|json|binary] [--counters]\n", argv[0]);
+        printf("%s --batch <trace directory | manifest> <schedule algorithm> [quantum] [switch cost] "
+               "[--jobs=N] [--format=csv|json|binary] [--counters]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const char *pcb_file = positional[0];
+    const char *algorithm = positional[1];
+    size_t quantum = 0;
+
+    if (positional_count >= 3)
+    {
+        quantum = atoi(positional[2]);
+    }
+    if (positional_count >= 4)
+    {
+        set_context_switch_cost(strtoul(positional[3], NULL, 10));
+    }
+
+    if (!valid_algorithm(algorithm))
     {
         printf("Invalid scheduling algorithm.\n");
-        dyn_array_destroy(ready_queue);
         return EXIT_FAILURE;
     }
 
-    printf("Average Waiting Time: %.2f\n", result.average_waiting_time);
-    printf("Average Turnaround Time: %.2f\n", result.average_turnaround_time);
-    printf("Total Clock Time: %lu\n", result.total_run_time);
+    // hardware counters only mean something in an instrumented build
+    if (counters && (!INSTRUMENT_ENABLED || !instrument_set_counters(true)))
+    {
+        fprintf(stderr, "Hardware counters unavailable, reporting timers only.\n");
+    }
+
+    if (batch)
+    {
+        // a batch report is a table, text means the default CSV
+        if (!format_given || format == FORMAT_TEXT)
+        {
+            format = FORMAT_CSV;
+        }
+        return run_batch(pcb_file, algorithm, quantum, worker_count > 0 ? (size_t) worker_count : 1, format);
+    }
+
+    RunRecord_t record;
+    record.trace = pcb_file;
+    struct timespec start, loaded, scheduled;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    dyn_array_t *ready_queue = load_process_control_blocks(pcb_file);
 
+    if (ready_queue == NULL)
+    {
+        printf("Failed to load process control blocks.\n");
+        return EXIT_FAILURE;
+    }
+
+    // the optional third argument is the deadline trace for EDF
+    dyn_array_t *deadlines = NULL;
+    if (strcmp(algorithm, EDF) == 0 && positional_count >= 3)
+    {
+        deadlines = load_process_deadlines(positional[2]);
+        if (deadlines == NULL)
+        {
+            printf("Failed to load process deadlines.\n");
+            dyn_array_destroy(ready_queue);
+            return EXIT_FAILURE;
+        }
+    }
+    record.job_count = dyn_array_size(ready_queue);
+    clock_gettime(CLOCK_MONOTONIC, &loaded);
+
+    record.success = run_algorithm(algorithm, ready_queue, quantum, deadlines, &record.result);
+    clock_gettime(CLOCK_MONOTONIC, &scheduled);
+    record.load_seconds = seconds_between(&start, &loaded);
+    record.schedule_seconds = seconds_between(&loaded, &scheduled);
+    record.has_queue_stats = dyn_array_get_stats(ready_queue, &record.queue_stats);
+    dyn_array_destroy(deadlines);
     dyn_array_destroy(ready_queue);
+    if (!record.success)
+    {
+        printf("Failed to execute %s algorithm.\n", algorithm);
+        return EXIT_FAILURE;
+    }
+
+    char *buffer = NULL;
+    size_t length = 0;
+    FILE *report = open_memstream(&buffer, &length);
+    if (report == NULL)
+    {
+        printf("Failed to allocate the report.\n");
+        return EXIT_FAILURE;
+    }
+    switch (format)
+    {
+    case FORMAT_CSV:
+        write_csv_header(report);
+        write_csv_row(report, &record);
+        break;
+    case FORMAT_JSON:
+        write_json_record(report, &record);
+        if (INSTRUMENT_ENABLED)
+        {
+            // tack the phases onto the run's object
+            fseek(report, -1, SEEK_CUR);
+            write_phases_json(report);
+            fputc('}', report);
+        }
+        fputc('\n', report);
+        break;
+    case FORMAT_BINARY:
+        write_binary_header(report, 1);
+        write_binary_record(report, &record);
+        break;
+    default:
+        write_text(report, &record);
+        fprintf(report, "Load/Schedule Time: %.6fs/%.6fs (%.0f jobs/s)\n", record.load_seconds,
+                record.schedule_seconds, jobs_per_second(&record));
+        if (INSTRUMENT_ENABLED)
+        {
+            write_phases_text(report);
+        }
+        if (record.has_queue_stats)
+        {
+            write_queue_stats_text(report, &record.queue_stats);
+        }
+        break;
+    }
 
-    return EXIT_SUCCESS;
+    return flush_report(report, &buffer, &length) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
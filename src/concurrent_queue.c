@@ -0,0 +1,396 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#include "concurrent_queue.h"
+#include "dyn_array.h"
+
+// Keeps the producer and consumer counters off each other's cache lines
+#define CACHE_LINE_SIZE 64
+
+
+
+//
+// Lock-free MPSC ring
+//
+// Bounded ring with a sequence number per slot (the Vyukov bounded queue, with the consumer side simplified).
+// Slot i is free for the producer claiming position p when sequence[i] == p,
+// and holds a published object for the consumer at position p when sequence[i] == p + 1.
+// The consumer hands the slot to the next lap by setting sequence[i] = p + capacity.
+//
+// A batch claims [p, p + count) with a single CAS. Checking only the last slot of the batch is enough,
+// the consumer frees slots strictly in order so every slot before a free one is free too.
+//
+
+struct concurrent_ring
+{
+    _Alignas(CACHE_LINE_SIZE) atomic_size_t enqueue_pos;
+    _Alignas(CACHE_LINE_SIZE) atomic_size_t dequeue_pos;
+    _Alignas(CACHE_LINE_SIZE) size_t mask;
+    size_t data_size;
+    atomic_size_t *sequence;
+    uint8_t *data;
+};
+
+#define RING_SLOT(ring_ptr, pos) ((ring_ptr)->data + (((pos) & (ring_ptr)->mask) * (ring_ptr)->data_size))
+
+// Copies count objects between the ring storage starting at pos and a flat buffer, in at most two pieces
+static void ring_copy(concurrent_ring_t *const ring, const size_t pos, uint8_t *const buffer, const size_t count,
+                      const bool into_ring)
+{
+    const size_t capacity = ring->mask + 1;
+    const size_t first = (pos & ring->mask) + count > capacity ? capacity - (pos & ring->mask) : count;
+    if (into_ring)
+    {
+        memcpy(RING_SLOT(ring, pos), buffer, first * ring->data_size);
+        memcpy(ring->data, buffer + first * ring->data_size, (count - first) * ring->data_size);
+    }
+    else
+    {
+        memcpy(buffer, RING_SLOT(ring, pos), first * ring->data_size);
+        memcpy(buffer + first * ring->data_size, ring->data, (count - first) * ring->data_size);
+    }
+}
+
+concurrent_ring_t *concurrent_ring_create(const size_t capacity, const size_t data_type_size)
+{
+    if (data_type_size && capacity && capacity <= (SIZE_MAX >> 2))
+    {
+        size_t actual_capacity = 16;
+        while (capacity > actual_capacity)
+        {
+            actual_capacity <<= 1;
+        }
+
+        concurrent_ring_t *ring = (concurrent_ring_t *) aligned_alloc(CACHE_LINE_SIZE, sizeof(concurrent_ring_t));
+        if (ring)
+        {
+            ring->sequence = (atomic_size_t *) malloc(actual_capacity * sizeof(atomic_size_t));
+            ring->data = (uint8_t *) malloc(actual_capacity * data_type_size);
+            if (ring->sequence && ring->data)
+            {
+                ring->mask = actual_capacity - 1;
+                ring->data_size = data_type_size;
+                for (size_t i = 0; i < actual_capacity; ++i)
+                {
+                    atomic_init(&ring->sequence[i], i);
+                }
+                atomic_init(&ring->enqueue_pos, 0);
+                atomic_init(&ring->dequeue_pos, 0);
+                return ring;
+            }
+            free(ring->sequence);
+            free(ring->data);
+            free(ring);
+        }
+    }
+    return NULL;
+}
+
+void concurrent_ring_destroy(concurrent_ring_t *const ring)
+{
+    if (ring)
+    {
+        free(ring->sequence);
+        free(ring->data);
+        free(ring);
+    }
+}
+
+bool concurrent_ring_push(concurrent_ring_t *const ring, const void *const object)
+{
+    return concurrent_ring_push_batch(ring, object, 1);
+}
+
+bool concurrent_ring_push_batch(concurrent_ring_t *const ring, const void *const objects, const size_t count)
+{
+    if (ring && objects && count && count <= ring->mask + 1)
+    {
+        size_t pos = atomic_load_explicit(&ring->enqueue_pos, memory_order_relaxed);
+        for (;;)
+        {
+            const size_t last = pos + count - 1;
+            const size_t seq = atomic_load_explicit(&ring->sequence[last & ring->mask], memory_order_acquire);
+            const intptr_t diff = (intptr_t) seq - (intptr_t) last;
+            if (diff == 0)
+            {
+                if (atomic_compare_exchange_weak_explicit(&ring->enqueue_pos, &pos, pos + count,
+                                                          memory_order_relaxed, memory_order_relaxed))
+                {
+                    break;
+                }
+                // lost the race, pos now holds the winner's end, go again
+            }
+            else if (diff < 0)
+            {
+                return false;  // consumer hasn't freed that far yet, we're full
+            }
+            else
+            {
+                pos = atomic_load_explicit(&ring->enqueue_pos, memory_order_relaxed);
+            }
+        }
+
+        ring_copy(ring, pos, (uint8_t *) objects, count, true);
+        for (size_t i = 0; i < count; ++i)
+        {
+            atomic_store_explicit(&ring->sequence[(pos + i) & ring->mask], pos + i + 1, memory_order_release);
+        }
+        return true;
+    }
+    return false;
+}
+
+bool concurrent_ring_pop(concurrent_ring_t *const ring, void *const object)
+{
+    return concurrent_ring_pop_batch(ring, object, 1) == 1;
+}
+
+size_t concurrent_ring_pop_batch(concurrent_ring_t *const ring, void *const objects, const size_t max_count)
+{
+    if (ring && objects && max_count)
+    {
+        const size_t pos = atomic_load_explicit(&ring->dequeue_pos, memory_order_relaxed);
+        size_t count = 0;
+        while (count < max_count && count <= ring->mask
+               && atomic_load_explicit(&ring->sequence[(pos + count) & ring->mask], memory_order_acquire)
+                      == pos + count + 1)
+        {
+            ++count;
+        }
+        if (count)
+        {
+            ring_copy(ring, pos, (uint8_t *) objects, count, false);
+            for (size_t i = 0; i < count; ++i)
+            {
+                atomic_store_explicit(&ring->sequence[(pos + i) & ring->mask], pos + i + ring->mask + 1,
+                                      memory_order_release);
+            }
+            atomic_store_explicit(&ring->dequeue_pos, pos + count, memory_order_relaxed);
+        }
+        return count;
+    }
+    return 0;
+}
+
+size_t concurrent_ring_size(const concurrent_ring_t *const ring)
+{
+    if (ring)
+    {
+        // casts drop the const, atomic loads don't modify anything
+        size_t head = atomic_load_explicit((atomic_size_t *) &ring->dequeue_pos, memory_order_relaxed);
+        size_t tail = atomic_load_explicit((atomic_size_t *) &ring->enqueue_pos, memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+    return 0;
+}
+
+size_t concurrent_ring_capacity(const concurrent_ring_t *const ring)
+{
+    if (ring)
+    {
+        return ring->mask + 1;
+    }
+    return 0;
+}
+
+
+
+//
+// Locked heap
+//
+// Each heap entry is a small header (key, sequence) followed by a copy of the object,
+// so sifting never has to call back into the key function.
+//
+
+typedef struct
+{
+    uint64_t key;
+    uint64_t seq;
+}
+heap_entry_header_t;
+
+struct concurrent_heap
+{
+    pthread_mutex_t lock;
+    dyn_array_t *entries;
+    size_t data_size;
+    size_t entry_size;
+    uint64_t next_seq;
+    uint64_t (*key_func)(const void *const);
+    uint8_t *scratch;   // one entry's worth, holds the entry being sifted
+};
+
+#define HEAP_ENTRY(heap_ptr, idx) (((uint8_t *) (heap_ptr)->entries->array) + ((idx) * (heap_ptr)->entry_size))
+
+static inline bool heap_entry_less(const uint8_t *const a, const uint8_t *const b)
+{
+    const heap_entry_header_t *header_a = (const heap_entry_header_t *) a;
+    const heap_entry_header_t *header_b = (const heap_entry_header_t *) b;
+    return header_a->key < header_b->key || (header_a->key == header_b->key && header_a->seq < header_b->seq);
+}
+
+// Sifts the entry in scratch up from idx (a hole) and drops it into place
+static void heap_sift_up(concurrent_heap_t *const heap, size_t idx)
+{
+    while (idx)
+    {
+        size_t parent = (idx - 1) >> 1;
+        if (!heap_entry_less(heap->scratch, HEAP_ENTRY(heap, parent)))
+        {
+            break;
+        }
+        memcpy(HEAP_ENTRY(heap, idx), HEAP_ENTRY(heap, parent), heap->entry_size);
+        idx = parent;
+    }
+    memcpy(HEAP_ENTRY(heap, idx), heap->scratch, heap->entry_size);
+}
+
+// Sifts the entry in scratch down from idx (a hole) and drops it into place
+static void heap_sift_down(concurrent_heap_t *const heap, const size_t size, size_t idx)
+{
+    for (;;)
+    {
+        size_t child = (idx << 1) + 1;
+        if (child >= size)
+        {
+            break;
+        }
+        if (child + 1 < size && heap_entry_less(HEAP_ENTRY(heap, child + 1), HEAP_ENTRY(heap, child)))
+        {
+            ++child;
+        }
+        if (!heap_entry_less(HEAP_ENTRY(heap, child), heap->scratch))
+        {
+            break;
+        }
+        memcpy(HEAP_ENTRY(heap, idx), HEAP_ENTRY(heap, child), heap->entry_size);
+        idx = child;
+    }
+    memcpy(HEAP_ENTRY(heap, idx), heap->scratch, heap->entry_size);
+}
+
+// Lock must be held
+static bool heap_push_locked(concurrent_heap_t *const heap, const void *const object)
+{
+    heap_entry_header_t *header = (heap_entry_header_t *) heap->scratch;
+    header->key = heap->key_func(object);
+    header->seq = heap->next_seq;
+    memcpy(heap->scratch + sizeof(heap_entry_header_t), object, heap->data_size);
+
+    // push the scratch copy to grow the array, then sift the hole it left
+    if (!dyn_array_push_back(heap->entries, heap->scratch))
+    {
+        return false;
+    }
+    ++heap->next_seq;
+    heap_sift_up(heap, dyn_array_size(heap->entries) - 1);
+    return true;
+}
+
+// Lock must be held, heap must not be empty
+static void heap_pop_locked(concurrent_heap_t *const heap, void *const object)
+{
+    memcpy(object, HEAP_ENTRY(heap, 0) + sizeof(heap_entry_header_t), heap->data_size);
+    dyn_array_extract_back(heap->entries, heap->scratch);
+    if (dyn_array_size(heap->entries))
+    {
+        heap_sift_down(heap, dyn_array_size(heap->entries), 0);
+    }
+}
+
+concurrent_heap_t *concurrent_heap_create(const size_t capacity, const size_t data_type_size,
+                                          uint64_t (*const key_func)(const void *const))
+{
+    if (data_type_size && key_func)
+    {
+        concurrent_heap_t *heap = (concurrent_heap_t *) malloc(sizeof(concurrent_heap_t));
+        if (heap)
+        {
+            // round the object up so the next entry's header stays 8-byte aligned
+            size_t padded_size = (data_type_size + 7) & ~((size_t) 7);
+            heap->data_size = data_type_size;
+            heap->entry_size = sizeof(heap_entry_header_t) + padded_size;
+            heap->next_seq = 0;
+            heap->key_func = key_func;
+            heap->entries = dyn_array_create(capacity, heap->entry_size, NULL);
+            heap->scratch = (uint8_t *) calloc(1, heap->entry_size);
+            if (heap->entries && heap->scratch && pthread_mutex_init(&heap->lock, NULL) == 0)
+            {
+                return heap;
+            }
+            dyn_array_destroy(heap->entries);
+            free(heap->scratch);
+            free(heap);
+        }
+    }
+    return NULL;
+}
+
+void concurrent_heap_destroy(concurrent_heap_t *const heap)
+{
+    if (heap)
+    {
+        pthread_mutex_destroy(&heap->lock);
+        dyn_array_destroy(heap->entries);
+        free(heap->scratch);
+        free(heap);
+    }
+}
+
+bool concurrent_heap_push(concurrent_heap_t *const heap, const void *const object)
+{
+    return concurrent_heap_push_batch(heap, object, 1);
+}
+
+bool concurrent_heap_push_batch(concurrent_heap_t *const heap, const void *const objects, const size_t count)
+{
+    if (heap && objects && count)
+    {
+        bool success = true;
+        pthread_mutex_lock(&heap->lock);
+        const uint8_t *object = (const uint8_t *) objects;
+        for (size_t i = 0; success && i < count; ++i, object += heap->data_size)
+        {
+            success = heap_push_locked(heap, object);
+        }
+        pthread_mutex_unlock(&heap->lock);
+        return success;
+    }
+    return false;
+}
+
+bool concurrent_heap_pop(concurrent_heap_t *const heap, void *const object)
+{
+    return concurrent_heap_pop_batch(heap, object, 1) == 1;
+}
+
+size_t concurrent_heap_pop_batch(concurrent_heap_t *const heap, void *const objects, const size_t max_count)
+{
+    size_t count = 0;
+    if (heap && objects)
+    {
+        uint8_t *object = (uint8_t *) objects;
+        pthread_mutex_lock(&heap->lock);
+        while (count < max_count && dyn_array_size(heap->entries))
+        {
+            heap_pop_locked(heap, object);
+            object += heap->data_size;
+            ++count;
+        }
+        pthread_mutex_unlock(&heap->lock);
+    }
+    return count;
+}
+
+size_t concurrent_heap_size(concurrent_heap_t *const heap)
+{
+    size_t size = 0;
+    if (heap)
+    {
+        pthread_mutex_lock(&heap->lock);
+        size = dyn_array_size(heap->entries);
+        pthread_mutex_unlock(&heap->lock);
+    }
+    return size;
+}
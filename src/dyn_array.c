@@ -1,4 +1,13 @@
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
 #include "dyn_array.h"
+#include "thread_pool.h"
+#include "instrumentation.h"
 
 // Flag values
 // SHRUNK to indicate shrink_to_fit was called and size needs to be corrected
@@ -15,16 +24,86 @@
 #define DYN_MAX_CAPACITY (((size_t) 1) << ((sizeof(size_t) << 3) - 8))
 #endif
 
+// Smallest array dyn_array_sort_parallel will split up, below this thread startup costs more than it saves
+// Each thread gets at least an eighth of this. Both can be externally set
+#ifndef DYN_PARALLEL_SORT_THRESHOLD
+#define DYN_PARALLEL_SORT_THRESHOLD (((size_t) 1) << 16)
+#endif
+#ifndef DYN_PARALLEL_SORT_MAX_THREADS
+#define DYN_PARALLEL_SORT_MAX_THREADS 256
+#endif
+
+// Transparent huge page size on x86-64 (and most arm64 kernels)
+#define DYN_HUGE_PAGE_SIZE (((size_t) 2) << 20)
+
 // casts pointer and does arithmetic to get index of element
 #define DYN_ARRAY_POSITION(dyn_array_ptr, idx) \
     (((uint8_t *) (dyn_array_ptr)->array) + ((idx) * (dyn_array_ptr)->data_size))
 // Gets the size (in bytes) of n dyn_array elements
 #define DYN_SIZE_N_ELEMS(dyn_array_ptr, n) ((dyn_array_ptr)->data_size * (n))
 
+// Statistics hooks, gone entirely unless we're a DYN_ARRAY_STATS build
+// The op hook takes possibly-NULL arrays since it goes first thing in the public functions
+#ifdef DYN_ARRAY_STATS
+// The operation counts are bumped by the const accessors too, and those may run on several threads sharing
+// one array, so they're atomic. Everything else only changes along with the array, which isn't thread safe anyway
+struct dyn_array_counters
+{
+    dyn_array_stats_t totals;           // ops unused, see below
+    atomic_size_t ops[DYN_OP_COUNT];
+};
+
+#define DYN_STATS_OP(dyn_array_ptr, op)                                                                \
+    do {                                                                                               \
+        if ((dyn_array_ptr)) {                                                                         \
+            atomic_fetch_add_explicit(&(dyn_array_ptr)->stats->ops[(op)], 1, memory_order_relaxed);    \
+        }                                                                                              \
+    } while (0)
+#define DYN_STATS_MOVED(dyn_array_ptr, bytes) ((dyn_array_ptr)->stats->totals.bytes_moved += (bytes))
+#define DYN_STATS_REALLOC(dyn_array_ptr, bytes)                                          \
+    do {                                                                                 \
+        ++(dyn_array_ptr)->stats->totals.reallocs;                                       \
+        (dyn_array_ptr)->stats->totals.bytes_reallocated += (bytes);                     \
+        if ((dyn_array_ptr)->capacity > (dyn_array_ptr)->stats->totals.peak_capacity) {  \
+            (dyn_array_ptr)->stats->totals.peak_capacity = (dyn_array_ptr)->capacity;    \
+        }                                                                                \
+    } while (0)
+#define DYN_STATS_SIZE(dyn_array_ptr)                                            \
+    do {                                                                         \
+        if ((dyn_array_ptr)->size > (dyn_array_ptr)->stats->totals.peak_size) {  \
+            (dyn_array_ptr)->stats->totals.peak_size = (dyn_array_ptr)->size;    \
+        }                                                                        \
+    } while (0)
+
+// Zeroes the counters, peaks restart from the array as it is now
+static void dyn_stats_reset(dyn_array_t *const dyn_array)
+{
+    memset(&dyn_array->stats->totals, 0, sizeof(dyn_array_stats_t));
+    dyn_array->stats->totals.peak_capacity = dyn_array->capacity;
+    dyn_array->stats->totals.peak_size = dyn_array->size;
+    for (size_t op = 0; op < DYN_OP_COUNT; ++op)
+    {
+        atomic_store_explicit(&dyn_array->stats->ops[op], 0, memory_order_relaxed);
+    }
+}
+#else
+#define DYN_STATS_OP(dyn_array_ptr, op) ((void) 0)
+#define DYN_STATS_MOVED(dyn_array_ptr, bytes) ((void) 0)
+#define DYN_STATS_REALLOC(dyn_array_ptr, bytes) ((void) 0)
+#define DYN_STATS_SIZE(dyn_array_ptr) ((void) 0)
+#endif
+
 
 
 // Modes of operation for dyn_shift
-typedef enum { MODE_INSERT = 0x01, MODE_EXTRACT = 0x02, MODE_ERASE = 0x06, TYPE_REMOVE = 0x02 } DYN_SHIFT_MODE;
+// DROP removes without copying out or destructing, for when the objects have already gone somewhere else
+typedef enum {
+    MODE_INSERT = 0x01,
+    MODE_EXTRACT = 0x02,
+    MODE_ERASE = 0x06,
+    MODE_DROP = 0x0A,
+    TYPE_REMOVE = 0x02
+} DYN_SHIFT_MODE;
 
 // The core of any insert/remove operation, check the impl for details
 // One inserts, one decreases. Super simple stuff.
@@ -35,10 +114,22 @@ bool dyn_shift_insert(dyn_array_t *const dyn_array, const size_t position, const
 bool dyn_shift_remove(dyn_array_t *const dyn_array, const size_t position, const size_t count,
                       const DYN_SHIFT_MODE mode, void *const data_dst);
 
+// Storage allocation honoring dyn_alloc_flags_t, free() releases it whichever way it went
+static void *dyn_storage_alloc(const unsigned int allocation, const size_t bytes);
+
+// Checks to see if the object can handle an increase in size (and optionally increases capacity)
+bool dyn_request_size_increase(dyn_array_t *const dyn_array, const size_t increment);
+
 
 
 
 dyn_array_t *dyn_array_create(const size_t capacity, const size_t data_type_size, void (*destruct_func)(void *)) 
+{
+    return dyn_array_create_with(capacity, data_type_size, destruct_func, DYN_ALLOC_DEFAULT);
+}
+
+dyn_array_t *dyn_array_create_with(const size_t capacity, const size_t data_type_size,
+                                   void (*destruct_func)(void *), const unsigned int allocation) 
 {
     if (data_type_size && capacity <= DYN_MAX_CAPACITY) 
     {
@@ -63,15 +154,34 @@ dyn_array_t *dyn_array_create(const size_t capacity, const size_t data_type_size
             // I had an idea... and it compiles
             // const members of a malloc'd struct are so annoying
             memcpy(dyn_array, &((dyn_array_t){actual_capacity, 0, data_type_size,
-                                              malloc(data_type_size * actual_capacity), destruct_func}),
+                                              dyn_storage_alloc(allocation, data_type_size * actual_capacity),
+                                              destruct_func, allocation
+#ifdef DYN_ARRAY_STATS
+                                              , NULL
+#endif
+                                              }),
                    sizeof(dyn_array_t));
 
+#ifdef DYN_ARRAY_STATS
+            dyn_array->stats = (struct dyn_array_counters *) malloc(sizeof(struct dyn_array_counters));
+            if (!dyn_array->stats) 
+            {
+                free(dyn_array->array);
+                free(dyn_array);
+                return NULL;
+            }
+            dyn_stats_reset(dyn_array);
+#endif
+
             if (dyn_array->array) 
             {
                 // other malloc worked, yay!
                 // we're done?
                 return dyn_array;
             }
+#ifdef DYN_ARRAY_STATS
+            free(dyn_array->stats);
+#endif
             free(dyn_array);
         }
     }
@@ -113,6 +223,9 @@ void dyn_array_destroy(dyn_array_t *dyn_array)
     if (dyn_array) {
         dyn_array_clear(dyn_array);
         free(dyn_array->array);
+#ifdef DYN_ARRAY_STATS
+        free(dyn_array->stats);
+#endif
         free(dyn_array);
     }
 }
@@ -122,6 +235,7 @@ void dyn_array_destroy(dyn_array_t *dyn_array)
 
 void *dyn_array_front(const dyn_array_t *const dyn_array) 
 {
+    DYN_STATS_OP(dyn_array, DYN_OP_FRONT);
     if (dyn_array && dyn_array->size) 
     {
         // If array is null, well, this is ok, because it's null
@@ -134,16 +248,19 @@ void *dyn_array_front(const dyn_array_t *const dyn_array)
 
 bool dyn_array_push_front(dyn_array_t *const dyn_array, const void *const object) 
 {
+    DYN_STATS_OP(dyn_array, DYN_OP_PUSH_FRONT);
     return dyn_shift_insert(dyn_array, 0, 1, MODE_INSERT, object);
 }
 
 bool dyn_array_pop_front(dyn_array_t *const dyn_array) 
 {
+    DYN_STATS_OP(dyn_array, DYN_OP_POP_FRONT);
     return dyn_shift_remove(dyn_array, 0, 1, MODE_ERASE, NULL);
 }
 
 bool dyn_array_extract_front(dyn_array_t *const dyn_array, void *const object) 
 {
+    DYN_STATS_OP(dyn_array, DYN_OP_EXTRACT_FRONT);
     return dyn_shift_remove(dyn_array, 0, 1, MODE_EXTRACT, object);
 }
 
@@ -152,6 +269,7 @@ bool dyn_array_extract_front(dyn_array_t *const dyn_array, void *const object)
 
 void *dyn_array_back(const dyn_array_t *const dyn_array) 
 {
+    DYN_STATS_OP(dyn_array, DYN_OP_BACK);
     if (dyn_array && dyn_array->size) 
     {
         return DYN_ARRAY_POSITION(dyn_array, dyn_array->size - 1);
@@ -161,17 +279,20 @@ void *dyn_array_back(const dyn_array_t *const dyn_array)
 
 bool dyn_array_push_back(dyn_array_t *const dyn_array, const void *const object) 
 {
+    DYN_STATS_OP(dyn_array, DYN_OP_PUSH_BACK);
     return dyn_array && dyn_shift_insert(dyn_array, dyn_array->size, 1, MODE_INSERT, (void *const) object);
 }
 
 bool dyn_array_pop_back(dyn_array_t *const dyn_array) 
 {
+    DYN_STATS_OP(dyn_array, DYN_OP_POP_BACK);
     // Assert size because rollunder is scary, (though it should be handled correctly)
     return dyn_array && dyn_array->size && dyn_shift_remove(dyn_array, dyn_array->size - 1, 1, MODE_ERASE, NULL);
 }
 
 bool dyn_array_extract_back(dyn_array_t *const dyn_array, void *const object) 
 {
+    DYN_STATS_OP(dyn_array, DYN_OP_EXTRACT_BACK);
     // Assert size because rollunder is scary, (though it should be handled correctly)
     return dyn_array && dyn_array->size && dyn_shift_remove(dyn_array, dyn_array->size - 1, 1, MODE_EXTRACT, object);
 }
@@ -179,6 +300,7 @@ bool dyn_array_extract_back(dyn_array_t *const dyn_array, void *const object)
 
 void *dyn_array_at(const dyn_array_t *const dyn_array, const size_t index) 
 {
+    DYN_STATS_OP(dyn_array, DYN_OP_AT);
     if (dyn_array && index < dyn_array->size) 
     {
         return DYN_ARRAY_POSITION(dyn_array, index);
@@ -188,6 +310,7 @@ void *dyn_array_at(const dyn_array_t *const dyn_array, const size_t index)
 
 bool dyn_array_insert(dyn_array_t *const dyn_array, const size_t index, const void *const object) 
 {
+    DYN_STATS_OP(dyn_array, DYN_OP_INSERT);
     // putting object at INDEX
     // so we shift a gap at INDEX
     return object && dyn_shift_insert(dyn_array, index, 1, MODE_INSERT, object);
@@ -195,18 +318,144 @@ bool dyn_array_insert(dyn_array_t *const dyn_array, const size_t index, const vo
 
 bool dyn_array_erase(dyn_array_t *const dyn_array, const size_t index) 
 {
+    DYN_STATS_OP(dyn_array, DYN_OP_ERASE);
     return dyn_shift_remove(dyn_array, index, 1, MODE_ERASE, NULL);
 }
 
 bool dyn_array_extract(dyn_array_t *const dyn_array, const size_t index, void *const object) 
 {
+    DYN_STATS_OP(dyn_array, DYN_OP_EXTRACT);
     return dyn_array && object && dyn_array->size > index
            && dyn_shift_remove(dyn_array, index, 1, MODE_EXTRACT, object);
 }
 
 
+bool dyn_array_append(dyn_array_t *const dyn_array, const void *const objects, const size_t count) 
+{
+    DYN_STATS_OP(dyn_array, DYN_OP_APPEND);
+    return dyn_array && dyn_shift_insert(dyn_array, dyn_array->size, count, MODE_INSERT, objects);
+}
+
+bool dyn_array_insert_range(dyn_array_t *const dyn_array, const size_t index, const void *const objects,
+                            const size_t count) 
+{
+    DYN_STATS_OP(dyn_array, DYN_OP_INSERT_RANGE);
+    return dyn_shift_insert(dyn_array, index, count, MODE_INSERT, objects);
+}
+
+bool dyn_array_erase_range(dyn_array_t *const dyn_array, const size_t index, const size_t count) 
+{
+    DYN_STATS_OP(dyn_array, DYN_OP_ERASE_RANGE);
+    return dyn_shift_remove(dyn_array, index, count, MODE_ERASE, NULL);
+}
+
+bool dyn_array_extract_range(dyn_array_t *const dyn_array, const size_t index, const size_t count,
+                             void *const objects) 
+{
+    DYN_STATS_OP(dyn_array, DYN_OP_EXTRACT_RANGE);
+    return objects && dyn_shift_remove(dyn_array, index, count, MODE_EXTRACT, objects);
+}
+
+bool dyn_array_splice(dyn_array_t *const destination, const size_t destination_index, dyn_array_t *const source,
+                      const size_t source_index, const size_t count) 
+{
+    DYN_STATS_OP(destination, DYN_OP_SPLICE);
+    DYN_STATS_OP(source, DYN_OP_SPLICE);
+    // Different arrays, so copying straight out of source's storage can't overlap, even if destination reallocs
+    // Range checks on source go first, once the objects are in destination the drop can't fail
+    if (destination && source && destination != source && destination->data_size == source->data_size
+        && source_index <= source->size && count <= source->size - source_index
+        && dyn_shift_insert(destination, destination_index, count, MODE_INSERT,
+                            DYN_ARRAY_POSITION(source, source_index))) 
+    {
+        return dyn_shift_remove(source, source_index, count, MODE_DROP, NULL);
+    }
+    return false;
+}
+
+
+// Fills the gap at index with the last object, the object at index must already be dealt with
+static void dyn_swap_fill(dyn_array_t *const dyn_array, const size_t index) 
+{
+    --dyn_array->size;
+    if (index != dyn_array->size) 
+    {
+        memcpy(DYN_ARRAY_POSITION(dyn_array, index), DYN_ARRAY_POSITION(dyn_array, dyn_array->size),
+               dyn_array->data_size);
+    }
+}
+
+bool dyn_array_swap_erase(dyn_array_t *const dyn_array, const size_t index) 
+{
+    DYN_STATS_OP(dyn_array, DYN_OP_SWAP_ERASE);
+    if (dyn_array && index < dyn_array->size) 
+    {
+        if (dyn_array->destructor) 
+        {
+            dyn_array->destructor(DYN_ARRAY_POSITION(dyn_array, index));
+        }
+        dyn_swap_fill(dyn_array, index);
+        return true;
+    }
+    return false;
+}
+
+bool dyn_array_swap_extract(dyn_array_t *const dyn_array, const size_t index, void *const object) 
+{
+    DYN_STATS_OP(dyn_array, DYN_OP_SWAP_EXTRACT);
+    if (dyn_array && object && index < dyn_array->size) 
+    {
+        memcpy(object, DYN_ARRAY_POSITION(dyn_array, index), dyn_array->data_size);
+        dyn_swap_fill(dyn_array, index);
+        return true;
+    }
+    return false;
+}
+
+size_t dyn_array_remove_if(dyn_array_t *const dyn_array, bool (*const predicate)(const void *const, void *),
+                           void *arg) 
+{
+    DYN_STATS_OP(dyn_array, DYN_OP_REMOVE_IF);
+    if (!dyn_array || !predicate) 
+    {
+        return 0;
+    }
+
+    // Survivors slide down over the removed objects a run at a time, so each one moves at most once
+    // and a run that's already in place (nothing removed before it) doesn't move at all
+    size_t write = 0;
+    size_t run_start = 0;
+    for (size_t read = 0; read <= dyn_array->size; ++read) 
+    {
+        if (read < dyn_array->size && !predicate(DYN_ARRAY_POSITION(dyn_array, read), arg)) 
+        {
+            continue;
+        }
+        // read ends a run of survivors, either on a removed object or off the end
+        const size_t run_length = read - run_start;
+        if (run_length && write != run_start) 
+        {
+            memmove(DYN_ARRAY_POSITION(dyn_array, write), DYN_ARRAY_POSITION(dyn_array, run_start),
+                    DYN_SIZE_N_ELEMS(dyn_array, run_length));
+            DYN_STATS_MOVED(dyn_array, DYN_SIZE_N_ELEMS(dyn_array, run_length));
+        }
+        write += run_length;
+        if (read < dyn_array->size && dyn_array->destructor) 
+        {
+            dyn_array->destructor(DYN_ARRAY_POSITION(dyn_array, read));
+        }
+        run_start = read + 1;
+    }
+
+    const size_t removed = dyn_array->size - write;
+    dyn_array->size = write;
+    return removed;
+}
+
+
 void dyn_array_clear(dyn_array_t *const dyn_array) 
 {
+    DYN_STATS_OP(dyn_array, DYN_OP_CLEAR);
     if (dyn_array && dyn_array->size) 
     {
         dyn_shift_remove(dyn_array, 0, dyn_array->size, MODE_ERASE, NULL);
@@ -249,39 +498,345 @@ size_t dyn_array_data_size(const dyn_array_t *const dyn_array)
 
 bool dyn_array_sort(dyn_array_t *const dyn_array, int (*const compare)(const void *, const void *)) 
 {
+    DYN_STATS_OP(dyn_array, DYN_OP_SORT);
     // hah, turns out there's a quicksort in cstdlib.
     // and it works exactly like we want it to
     if (dyn_array && dyn_array->size && compare) 
     {
+        INSTRUMENT_SCOPE(INSTRUMENT_SORT);
         qsort(dyn_array->array, dyn_array->size, dyn_array->data_size, compare);
         return true;
     }
     return false;
 }
 
+// Parallel sort
+//
+// The array is cut into one chunk per thread and each thread qsorts its own. Then runs of chunks are merged
+// pairwise, doubling the run length each round, ping-ponging between the array and a buffer.
+// Every thread helps merge whichever pair its chunk is in, taking an equal slice of that pair's output.
+// Where a slice starts in each run is found by binary search (the "merge path"), so slices are independent.
+// A round's threads are joined before the next starts, the join is the barrier.
+
+typedef enum {
+    SORT_CHUNKS,
+    SORT_MERGE,
+    SORT_COPY_BACK,
+} DYN_SORT_PHASE;
+
+typedef struct
+{
+    DYN_SORT_PHASE phase;
+    const uint8_t *source;      // where this round's runs are
+    uint8_t *destination;
+    size_t size;                // objects in the whole array
+    size_t data_size;
+    int (*compare)(const void *, const void *);
+    size_t threads;
+    size_t thread;
+    size_t width;               // chunks per run being merged
+}
+dyn_sort_task_t;
+
+// total * part / parts without the multiply overflowing, part <= parts
+static inline size_t dyn_sort_share(const size_t total, const size_t part, const size_t parts)
+{
+    return total / parts * part + total % parts * part / parts;
+}
+
+// First object of chunk, or the size for chunk == threads
+static inline size_t dyn_sort_chunk_start(const dyn_sort_task_t *const task, const size_t chunk)
+{
+    return dyn_sort_share(task->size, chunk, task->threads);
+}
+
+// Number of objects from a that come first in the first output objects of merging a with b
+// Equal objects go a then b
+static size_t dyn_sort_co_rank(const dyn_sort_task_t *const task, const uint8_t *const a, const size_t a_size,
+                               const uint8_t *const b, const size_t b_size, const size_t output)
+{
+    size_t low = output > b_size ? output - b_size : 0;
+    size_t high = output < a_size ? output : a_size;
+    while (low < high)
+    {
+        // Too few from a if a's next object belongs before the last one we'd take from b
+        const size_t from_a = low + (high - low) / 2;
+        const size_t from_b = output - from_a;
+        if (task->compare(a + from_a * task->data_size, b + (from_b - 1) * task->data_size) <= 0)
+        {
+            low = from_a + 1;
+        }
+        else
+        {
+            high = from_a;
+        }
+    }
+    return low;
+}
+
+static void *dyn_sort_worker(void *arg)
+{
+    const dyn_sort_task_t *const task = (const dyn_sort_task_t *) arg;
+    const size_t data_size = task->data_size;
+
+    if (task->phase == SORT_CHUNKS || task->phase == SORT_COPY_BACK)
+    {
+        const size_t start = dyn_sort_chunk_start(task, task->thread);
+        const size_t end = dyn_sort_chunk_start(task, task->thread + 1);
+        if (task->phase == SORT_CHUNKS)
+        {
+            qsort(task->destination + start * data_size, end - start, data_size, task->compare);
+        }
+        else
+        {
+            memcpy(task->destination + start * data_size, task->source + start * data_size, (end - start) * data_size);
+        }
+        return NULL;
+    }
+
+    // The pair of runs this thread's chunk is in, and which of the pair's helpers this thread is
+    const size_t first = task->thread - task->thread % (2 * task->width);
+    const size_t middle = first + task->width < task->threads ? first + task->width : task->threads;
+    const size_t last = middle + task->width < task->threads ? middle + task->width : task->threads;
+    const size_t pair_start = dyn_sort_chunk_start(task, first);
+    const size_t pair_size = dyn_sort_chunk_start(task, last) - pair_start;
+    const size_t helpers = last - first;
+    const size_t helper = task->thread - first;
+    const size_t output_start = dyn_sort_share(pair_size, helper, helpers);
+    const size_t output_end = dyn_sort_share(pair_size, helper + 1, helpers);
+
+    const uint8_t *a = task->source + pair_start * data_size;
+    const size_t a_size = dyn_sort_chunk_start(task, middle) - pair_start;
+    const uint8_t *b = a + a_size * data_size;
+    const size_t b_size = pair_size - a_size;
+    size_t from_a = dyn_sort_co_rank(task, a, a_size, b, b_size, output_start);
+    size_t from_b = output_start - from_a;
+    uint8_t *out = task->destination + (pair_start + output_start) * data_size;
+
+    for (size_t output = output_start; output < output_end; ++output, out += data_size)
+    {
+        if (from_b == b_size
+            || (from_a < a_size && task->compare(a + from_a * data_size, b + from_b * data_size) <= 0))
+        {
+            memcpy(out, a + from_a++ * data_size, data_size);
+        }
+        else
+        {
+            memcpy(out, b + from_b++ * data_size, data_size);
+        }
+    }
+    return NULL;
+}
+
+// Runs one round on every thread, doing a thread's share ourselves if it couldn't be started
+static void dyn_sort_round(dyn_sort_task_t *const tasks, const size_t threads)
+{
+    pthread_t handles[DYN_PARALLEL_SORT_MAX_THREADS];
+    bool started[DYN_PARALLEL_SORT_MAX_THREADS];
+    for (size_t thread = 1; thread < threads; ++thread)
+    {
+        started[thread] = pthread_create(&handles[thread], NULL, dyn_sort_worker, &tasks[thread]) == 0;
+        if (!started[thread])
+        {
+            dyn_sort_worker(&tasks[thread]);
+        }
+    }
+    dyn_sort_worker(&tasks[0]);
+    for (size_t thread = 1; thread < threads; ++thread)
+    {
+        if (started[thread])
+        {
+            pthread_join(handles[thread], NULL);
+        }
+    }
+}
+
+bool dyn_array_sort_parallel(dyn_array_t *const dyn_array, int (*const compare)(const void *, const void *),
+                             const size_t threads) 
+{
+    DYN_STATS_OP(dyn_array, DYN_OP_SORT_PARALLEL);
+    if (!dyn_array || !dyn_array->size || !compare) 
+    {
+        return false;
+    }
+    // Before asking how many CPUs there are, that reads /sys and small sorts are common
+    if (dyn_array->size < DYN_PARALLEL_SORT_THRESHOLD) 
+    {
+        return dyn_array_sort(dyn_array, compare);
+    }
+
+    size_t thread_count = threads;
+    if (!thread_count) 
+    {
+        const long online = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_count = online > 0 ? (size_t) online : 1;
+    }
+    if (thread_count > DYN_PARALLEL_SORT_MAX_THREADS) 
+    {
+        thread_count = DYN_PARALLEL_SORT_MAX_THREADS;
+    }
+    if (thread_count > dyn_array->size / (DYN_PARALLEL_SORT_THRESHOLD / 8)) 
+    {
+        thread_count = dyn_array->size / (DYN_PARALLEL_SORT_THRESHOLD / 8);
+    }
+
+    uint8_t *buffer = NULL;
+    if (thread_count < 2
+        || !(buffer = (uint8_t *) dyn_storage_alloc(dyn_array->allocation & DYN_ALLOC_HUGE_PAGES,
+                                                    DYN_SIZE_N_ELEMS(dyn_array, dyn_array->size)))) 
+    {
+        return dyn_array_sort(dyn_array, compare);
+    }
+
+    // No first touch for the buffer even if the array has it, each thread touching the slices it writes
+    // in the first merge round is what keeps them local
+    INSTRUMENT_SCOPE(INSTRUMENT_SORT);
+    dyn_sort_task_t tasks[DYN_PARALLEL_SORT_MAX_THREADS];
+    for (size_t thread = 0; thread < thread_count; ++thread) 
+    {
+        tasks[thread] = (dyn_sort_task_t){SORT_CHUNKS, NULL, (uint8_t *) dyn_array->array, dyn_array->size,
+                                          dyn_array->data_size, compare, thread_count, thread, 0};
+    }
+    dyn_sort_round(tasks, thread_count);
+
+    uint8_t *source = (uint8_t *) dyn_array->array;
+    uint8_t *destination = buffer;
+    for (size_t width = 1; width < thread_count; width *= 2) 
+    {
+        for (size_t thread = 0; thread < thread_count; ++thread) 
+        {
+            tasks[thread].phase = SORT_MERGE;
+            tasks[thread].source = source;
+            tasks[thread].destination = destination;
+            tasks[thread].width = width;
+        }
+        dyn_sort_round(tasks, thread_count);
+        uint8_t *swap = source;
+        source = destination;
+        destination = swap;
+    }
+
+    // An odd number of rounds leaves it all in the buffer
+    if (source == buffer) 
+    {
+        for (size_t thread = 0; thread < thread_count; ++thread) 
+        {
+            tasks[thread].phase = SORT_COPY_BACK;
+            tasks[thread].source = buffer;
+            tasks[thread].destination = (uint8_t *) dyn_array->array;
+        }
+        dyn_sort_round(tasks, thread_count);
+    }
+    free(buffer);
+    return true;
+}
+
+
+// Binary search over [low, high) for the first object that object doesn't compare greater than
+// (or with upper set, greater than or equal to)
+static size_t dyn_bound(const dyn_array_t *const dyn_array, size_t low, size_t high, const void *const object,
+                        int (*const compare)(const void *, const void *), const bool upper) 
+{
+    while (low < high) 
+    {
+        const size_t middle = low + (high - low) / 2;
+        const int order = compare(object, DYN_ARRAY_POSITION(dyn_array, middle));
+        if (order > 0 || (upper && order == 0)) 
+        {
+            low = middle + 1;
+        } 
+        else 
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
 
 bool dyn_array_insert_sorted(dyn_array_t *const dyn_array, const void *const object,
                              int (*const compare)(const void *, const void *)) 
 {
+    DYN_STATS_OP(dyn_array, DYN_OP_INSERT_SORTED);
     if (dyn_array && compare && object) 
     {
-        size_t ordered_position = 0;
-        if (dyn_array->size) 
-        {
-            while (ordered_position < dyn_array->size
-                   && compare(object, DYN_ARRAY_POSITION(dyn_array, ordered_position)) > 0) 
-            {
-                ++ordered_position;
-            }
-        }
+        const size_t ordered_position = dyn_bound(dyn_array, 0, dyn_array->size, object, compare, false);
         return dyn_shift_insert(dyn_array, ordered_position, 1, MODE_INSERT, object);
     }
     return false;
 }
 
+size_t dyn_array_lower_bound(const dyn_array_t *const dyn_array, const void *const object,
+                             int (*const compare)(const void *, const void *)) 
+{
+    DYN_STATS_OP(dyn_array, DYN_OP_LOWER_BOUND);
+    if (dyn_array && object && compare) 
+    {
+        return dyn_bound(dyn_array, 0, dyn_array->size, object, compare, false);
+    }
+    return 0;
+}
+
+size_t dyn_array_upper_bound(const dyn_array_t *const dyn_array, const void *const object,
+                             int (*const compare)(const void *, const void *)) 
+{
+    DYN_STATS_OP(dyn_array, DYN_OP_UPPER_BOUND);
+    if (dyn_array && object && compare) 
+    {
+        return dyn_bound(dyn_array, 0, dyn_array->size, object, compare, true);
+    }
+    return 0;
+}
+
+bool dyn_array_merge_sorted(dyn_array_t *const dyn_array, const void *const objects, const size_t count,
+                            int (*const compare)(const void *, const void *)) 
+{
+    DYN_STATS_OP(dyn_array, DYN_OP_MERGE_SORTED);
+    if (!dyn_array || !objects || !count || !compare) 
+    {
+        return false;
+    }
+
+    // Nothing up to the batch's first object's upper bound moves, for a batch landing at the end that's everything
+    const uint8_t *batch = (const uint8_t *) objects;
+    const size_t settled = dyn_bound(dyn_array, 0, dyn_array->size, batch, compare, true);
+    if (!dyn_request_size_increase(dyn_array, count)) 
+    {
+        return false;
+    }
+
+    // Merge from the back into the new space, runs of the array that go after each batch object are found by
+    // binary search and go in one memmove, so a small batch into a big array costs a few compares and a shift
+    // Always existing + incoming == the next slot to fill from the back, plus one
+    size_t existing = dyn_array->size;
+    size_t incoming = count;
+    while (incoming) 
+    {
+        if (existing == settled) 
+        {
+            memcpy(DYN_ARRAY_POSITION(dyn_array, existing), batch, DYN_SIZE_N_ELEMS(dyn_array, incoming));
+            break;
+        }
+        const uint8_t *object = batch + DYN_SIZE_N_ELEMS(dyn_array, incoming - 1);
+        const size_t run_start = dyn_bound(dyn_array, settled, existing, object, compare, true);
+        if (run_start != existing) 
+        {
+            memmove(DYN_ARRAY_POSITION(dyn_array, run_start + incoming), DYN_ARRAY_POSITION(dyn_array, run_start),
+                    DYN_SIZE_N_ELEMS(dyn_array, existing - run_start));
+            DYN_STATS_MOVED(dyn_array, DYN_SIZE_N_ELEMS(dyn_array, existing - run_start));
+            existing = run_start;
+        }
+        --incoming;
+        memcpy(DYN_ARRAY_POSITION(dyn_array, existing + incoming), object, dyn_array->data_size);
+    }
+    dyn_array->size += count;
+    DYN_STATS_SIZE(dyn_array);
+    return true;
+}
+
 
 bool dyn_array_for_each(dyn_array_t *const dyn_array, void (*const func)(void *const, void *), void *arg) 
 {
+    DYN_STATS_OP(dyn_array, DYN_OP_FOR_EACH);
     if (dyn_array && dyn_array->array && func) 
     {
         // So I just noticed we never check the data array ever
@@ -302,6 +857,184 @@ bool dyn_array_for_each(dyn_array_t *const dyn_array, void (*const func)(void *c
     return false;
 }
 
+bool dyn_array_for_each_block(dyn_array_t *const dyn_array, void (*const func)(void *const, const size_t, void *),
+                              void *arg, const size_t block_size) 
+{
+    DYN_STATS_OP(dyn_array, DYN_OP_FOR_EACH_BLOCK);
+    if (dyn_array && dyn_array->array && func) 
+    {
+        const size_t block = block_size ? block_size : dyn_array->size;
+        for (size_t idx = 0; idx < dyn_array->size; idx += block) 
+        {
+            const size_t count = dyn_array->size - idx < block ? dyn_array->size - idx : block;
+            func(DYN_ARRAY_POSITION(dyn_array, idx), count, arg);
+        }
+        return true;
+    }
+    return false;
+}
+
+// Parallel for_each
+//
+// Chunk i of the array goes to accumulator i. The chunks are run as pool tasks, so whichever thread is free
+// takes the next one, and merging waits until the run has returned.
+
+// Below this many objects per chunk a thread costs more to wake than it saves
+#ifndef DYN_PARALLEL_FOR_EACH_MIN_CHUNK
+#define DYN_PARALLEL_FOR_EACH_MIN_CHUNK 4096
+#endif
+
+typedef struct
+{
+    dyn_array_t *dyn_array;
+    void (*func)(void *const, const size_t, void *);
+    uint8_t *accumulators;
+    size_t accumulator_size;
+    size_t chunks;
+}
+dyn_for_each_job_t;
+
+static void dyn_for_each_chunk(const size_t chunk, void *arg)
+{
+    const dyn_for_each_job_t *const job = (const dyn_for_each_job_t *) arg;
+    const size_t start = dyn_sort_share(job->dyn_array->size, chunk, job->chunks);
+    const size_t end = dyn_sort_share(job->dyn_array->size, chunk + 1, job->chunks);
+    job->func(DYN_ARRAY_POSITION(job->dyn_array, start), end - start,
+              job->accumulators ? job->accumulators + chunk * job->accumulator_size : NULL);
+}
+
+bool dyn_array_for_each_parallel(dyn_array_t *const dyn_array, struct thread_pool *const pool,
+                                 void (*const func)(void *const, const size_t, void *), void *accumulators,
+                                 const size_t accumulator_size, void (*const merge)(void *, const void *)) 
+{
+    DYN_STATS_OP(dyn_array, DYN_OP_FOR_EACH_PARALLEL);
+    if (!dyn_array || !dyn_array->array || !func || (accumulators && !accumulator_size)) 
+    {
+        return false;
+    }
+
+    size_t chunks = thread_pool_size(pool);
+    if (chunks > dyn_array->size / DYN_PARALLEL_FOR_EACH_MIN_CHUNK) 
+    {
+        chunks = dyn_array->size / DYN_PARALLEL_FOR_EACH_MIN_CHUNK;
+    }
+    if (chunks < 2) 
+    {
+        if (dyn_array->size) 
+        {
+            func(dyn_array->array, dyn_array->size, accumulators);
+        }
+        return true;
+    }
+
+    dyn_for_each_job_t job = {dyn_array, func, (uint8_t *) accumulators, accumulator_size, chunks};
+    thread_pool_run(pool, dyn_for_each_chunk, &job, chunks);
+    for (size_t chunk = 1; merge && accumulators && chunk < chunks; ++chunk) 
+    {
+        merge(accumulators, job.accumulators + chunk * accumulator_size);
+    }
+    return true;
+}
+
+// One pass over a uint32_t field every stride bytes. A macro so each stride the switch below picks is
+// compiled with the stride as a constant, which is what lets the loop be unrolled and vectorized
+#define DYN_REDUCE_U32(field, count, stride, sum, min, max) \
+    for (size_t idx = 0; idx < (count); ++idx) \
+    { \
+        uint32_t value; \
+        memcpy(&value, (field) + idx * (stride), sizeof(uint32_t)); \
+        (sum) += value; \
+        (min) = value < (min) ? value : (min); \
+        (max) = value > (max) ? value : (max); \
+    }
+
+bool dyn_array_reduce_u32(const dyn_array_t *const dyn_array, const size_t offset,
+                          dyn_array_u32_reduction_t *const reduction) 
+{
+    DYN_STATS_OP(dyn_array, DYN_OP_REDUCE_U32);
+    if (!dyn_array || !reduction || offset > dyn_array->data_size
+        || dyn_array->data_size - offset < sizeof(uint32_t)) 
+    {
+        return false;
+    }
+
+    const uint8_t *field = (const uint8_t *) dyn_array->array + offset;
+    const size_t count = dyn_array->size;
+    uint64_t sum = 0;
+    uint32_t min = UINT32_MAX;
+    uint32_t max = 0;
+    switch (dyn_array->data_size) 
+    {
+        case 4:
+            DYN_REDUCE_U32(field, count, 4, sum, min, max);
+            break;
+        case 8:
+            DYN_REDUCE_U32(field, count, 8, sum, min, max);
+            break;
+        case 12:
+            DYN_REDUCE_U32(field, count, 12, sum, min, max);
+            break;
+        case 16:
+            DYN_REDUCE_U32(field, count, 16, sum, min, max);
+            break;
+        default:
+            DYN_REDUCE_U32(field, count, dyn_array->data_size, sum, min, max);
+            break;
+    }
+    reduction->sum = sum;
+    reduction->min = min;
+    reduction->max = max;
+    return true;
+}
+
+
+bool dyn_array_get_stats(const dyn_array_t *const dyn_array, dyn_array_stats_t *const stats) 
+{
+#ifdef DYN_ARRAY_STATS
+    if (dyn_array && stats) 
+    {
+        *stats = dyn_array->stats->totals;
+        for (size_t op = 0; op < DYN_OP_COUNT; ++op) 
+        {
+            stats->ops[op] = atomic_load_explicit(&dyn_array->stats->ops[op], memory_order_relaxed);
+        }
+        return true;
+    }
+#else
+    (void) dyn_array;
+    (void) stats;
+#endif
+    return false;
+}
+
+void dyn_array_reset_stats(dyn_array_t *const dyn_array) 
+{
+#ifdef DYN_ARRAY_STATS
+    if (dyn_array) 
+    {
+        dyn_stats_reset(dyn_array);
+    }
+#else
+    (void) dyn_array;
+#endif
+}
+
+const char *dyn_array_op_name(const dyn_array_op_t op) 
+{
+    static const char *const names[DYN_OP_COUNT] = {
+        "front", "back", "at", "push_front", "pop_front", "extract_front", "push_back", "pop_back",
+        "extract_back", "insert", "erase", "extract", "clear", "sort", "insert_sorted", "for_each",
+        "append", "insert_range", "erase_range", "extract_range", "splice", "swap_erase", "swap_extract",
+        "remove_if", "lower_bound", "upper_bound", "merge_sorted", "sort_parallel",
+        "for_each_block", "reduce_u32", "for_each_parallel",
+    };
+    if ((size_t) op < DYN_OP_COUNT) 
+    {
+        return names[op];
+    }
+    return NULL;
+}
+
 
 /*
     // No return value. It either goes or it doesn't. shrink_to_fit is more of a request
@@ -326,9 +1059,6 @@ bool dyn_array_for_each(dyn_array_t *const dyn_array, void (*const func)(void *c
 //
 
 
-// Checks to see if the object can handle an increase in size (and optionally increases capacity)
-bool dyn_request_size_increase(dyn_array_t *const dyn_array, const size_t increment);
-
 #define MODE_IS_TYPE(mode, type) ((mode) & (type))
 
 // inserting between idx 1 and 2 (between B and C) means you're moving everything from 2 down to make room
@@ -353,9 +1083,11 @@ bool dyn_shift_insert(dyn_array_t *const dyn_array, const size_t position, const
             {  // wasn't a gap at the end, we need to move data
                 memmove(DYN_ARRAY_POSITION(dyn_array, position + count), DYN_ARRAY_POSITION(dyn_array, position),
                         DYN_SIZE_N_ELEMS(dyn_array, dyn_array->size - position));
+                DYN_STATS_MOVED(dyn_array, DYN_SIZE_N_ELEMS(dyn_array, dyn_array->size - position));
             }
             memcpy(DYN_ARRAY_POSITION(dyn_array, position), data_src, dyn_array->data_size * count);
             dyn_array->size += count;
+            DYN_STATS_SIZE(dyn_array);
             return true;
         }
     }
@@ -387,7 +1119,7 @@ bool dyn_shift_remove(dyn_array_t *const dyn_array, const size_t position, const
                 }
             }
         } 
-        else 
+        else if (mode == MODE_EXTRACT) 
         {  // extracting data
             if (data_dst) 
             {
@@ -406,6 +1138,7 @@ bool dyn_shift_remove(dyn_array_t *const dyn_array, const size_t position, const
             // there's a actual gap, not just a hole to make at the end
             memmove(DYN_ARRAY_POSITION(dyn_array, position), DYN_ARRAY_POSITION(dyn_array, position + count),
                     DYN_SIZE_N_ELEMS(dyn_array, dyn_array->size - (position + count)));
+            DYN_STATS_MOVED(dyn_array, DYN_SIZE_N_ELEMS(dyn_array, dyn_array->size - (position + count)));
         }
         // decrease the size and return
         dyn_array->size -= count;
@@ -414,6 +1147,85 @@ bool dyn_shift_remove(dyn_array_t *const dyn_array, const size_t position, const
     return false;
 }
 
+// Writes a byte in every page of [start, end) so the pages are faulted in on this thread
+// Only for storage that doesn't hold anything yet
+static void dyn_first_touch(uint8_t *const storage, const size_t start, const size_t end) 
+{
+    const long page_size = sysconf(_SC_PAGESIZE);
+    const size_t step = page_size > 0 ? (size_t) page_size : 4096;
+    for (size_t offset = start; offset < end; offset += step) 
+    {
+        ((volatile uint8_t *) storage)[offset] = 0;
+    }
+}
+
+// Huge page storage is rounded up to whole huge pages, NULL if it's too small to bother or can't be had
+static void *dyn_huge_alloc(const size_t bytes) 
+{
+#ifdef MADV_HUGEPAGE
+    if (bytes >= DYN_HUGE_PAGE_SIZE) 
+    {
+        const size_t rounded = (bytes + DYN_HUGE_PAGE_SIZE - 1) & ~(DYN_HUGE_PAGE_SIZE - 1);
+        void *storage;
+        if (rounded >= bytes && posix_memalign(&storage, DYN_HUGE_PAGE_SIZE, rounded) == 0) 
+        {
+            // just advice, if THP is off we still have the memory
+            madvise(storage, rounded, MADV_HUGEPAGE);
+            return storage;
+        }
+    }
+#else
+    (void) bytes;
+#endif
+    return NULL;
+}
+
+static void *dyn_storage_alloc(const unsigned int allocation, const size_t bytes) 
+{
+    void *storage = NULL;
+    if (allocation & DYN_ALLOC_HUGE_PAGES) 
+    {
+        storage = dyn_huge_alloc(bytes);
+    }
+    if (!storage) 
+    {
+        storage = malloc(bytes);
+    }
+    if (storage && (allocation & DYN_ALLOC_FIRST_TOUCH)) 
+    {
+        dyn_first_touch((uint8_t *) storage, 0, bytes);
+    }
+    return storage;
+}
+
+// Grows the storage to bytes, keeping the contents. Plain realloc unless the array asked for more
+// Doesn't touch dyn_array, the caller updates it on success
+static void *dyn_storage_resize(dyn_array_t *const dyn_array, const size_t bytes) 
+{
+    const size_t used = DYN_SIZE_N_ELEMS(dyn_array, dyn_array->size);
+    void *storage = NULL;
+    if (dyn_array->allocation & DYN_ALLOC_HUGE_PAGES) 
+    {
+        // realloc would lose the alignment, so it's a copy of what's in use into new storage
+        storage = dyn_huge_alloc(bytes);
+        if (storage) 
+        {
+            memcpy(storage, dyn_array->array, used);
+            free(dyn_array->array);
+        }
+    }
+    if (!storage) 
+    {
+        storage = realloc(dyn_array->array, bytes);
+    }
+    // The objects in use were copied or kept, so they're resident, it's only what's past them that needs faulting in
+    if (storage && (dyn_array->allocation & DYN_ALLOC_FIRST_TOUCH)) 
+    {
+        dyn_first_touch((uint8_t *) storage, used, bytes);
+    }
+    return storage;
+}
+
 bool dyn_request_size_increase(dyn_array_t *const dyn_array, const size_t increment) 
 {
     // check to see if the size can be increased by the increment
@@ -444,12 +1256,13 @@ bool dyn_request_size_increase(dyn_array_t *const dyn_array, const size_t increm
             // we can theoretically hold this, check if we can allocate that
             // if (!MULTIPLY_MAY_OVERFLOW(new_capacity, dyn_array->data_size)) {
             // we won't overflow, so we can at least REQUEST this change
-            void *new_array = realloc(dyn_array->array, new_capacity * dyn_array->data_size);
+            void *new_array = dyn_storage_resize(dyn_array, new_capacity * dyn_array->data_size);
             if (new_array) 
             {
                 // success! Wasn't that easy?
                 dyn_array->array    = new_array;
                 dyn_array->capacity = new_capacity;
+                DYN_STATS_REALLOC(dyn_array, new_capacity * dyn_array->data_size);
                 return true;
             }
         }
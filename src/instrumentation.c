@@ -0,0 +1,241 @@
+#define _GNU_SOURCE
+
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#include "instrumentation.h"
+
+// Process-wide totals, relaxed atomics since they're only ever summed and read after the fact
+typedef struct
+{
+    atomic_uint_fast64_t calls;
+    atomic_uint_fast64_t nanoseconds;
+    atomic_uint_fast64_t ticks;
+    atomic_uint_fast64_t counted_calls;
+    atomic_uint_fast64_t counters[INSTRUMENT_COUNTER_COUNT];
+}
+instrument_totals_t;
+
+static instrument_totals_t totals[INSTRUMENT_PHASE_COUNT];
+static atomic_bool counters_enabled = false;
+
+// Every thread opens its own counter group the first time it needs one, -1 until then, -2 if it can't
+// The group is the leader's fd, counter_fds holds it and every member so instrument_thread_exit can close them
+static _Thread_local int counter_group = -1;
+static _Thread_local int counter_fds[INSTRUMENT_COUNTER_COUNT];
+
+static const char *const phase_names[INSTRUMENT_PHASE_COUNT] = { "load", "sort", "schedule" };
+static const char *const counter_names[INSTRUMENT_COUNTER_COUNT] = { "cycles", "instructions", "cache_misses",
+                                                                     "branch_misses" };
+
+static inline uint64_t instrument_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000u + (uint64_t) now.tv_nsec;
+}
+
+static inline uint64_t instrument_ticks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+#ifdef __linux__
+static int open_counter(const uint64_t type, const uint64_t config, const int group)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = (uint32_t) type;
+    attr.config = config;
+    attr.disabled = group < 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return (int) syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+// Opens cycles, instructions, cache and branch misses as one group so they're read together
+static bool open_counter_group(void)
+{
+    const uint64_t events[INSTRUMENT_COUNTER_COUNT][2] = {
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    };
+
+    // members stay open along with the leader until instrument_thread_exit
+    int fds[INSTRUMENT_COUNTER_COUNT];
+    for (size_t i = 0; i < INSTRUMENT_COUNTER_COUNT; ++i)
+    {
+        fds[i] = open_counter(events[i][0], events[i][1], i ? fds[0] : -1);
+        if (fds[i] < 0)
+        {
+            // e.g. cache misses are often missing in a VM, give back whatever did open
+            while (i--)
+            {
+                close(fds[i]);
+            }
+            counter_group = -2;
+            return false;
+        }
+    }
+    ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    memcpy(counter_fds, fds, sizeof(fds));
+    counter_group = fds[0];
+    return true;
+}
+
+static bool read_counters(uint64_t *const counters)
+{
+    // PERF_FORMAT_GROUP: the number of events then each value
+    uint64_t values[1 + INSTRUMENT_COUNTER_COUNT];
+    if (read(counter_group, values, sizeof(values)) != (ssize_t) sizeof(values))
+    {
+        return false;
+    }
+    memcpy(counters, values + 1, sizeof(uint64_t) * INSTRUMENT_COUNTER_COUNT);
+    return true;
+}
+#else
+static bool open_counter_group(void)
+{
+    counter_group = -2;
+    return false;
+}
+
+static bool read_counters(uint64_t *const counters)
+{
+    (void) counters;
+    return false;
+}
+#endif
+
+instrument_scope_t instrument_begin(const instrument_phase_t phase)
+{
+    instrument_scope_t scope;
+    scope.phase = phase;
+    scope.counting = false;
+    if (atomic_load_explicit(&counters_enabled, memory_order_relaxed)
+        && (counter_group >= 0 || (counter_group == -1 && open_counter_group())))
+    {
+        scope.counting = read_counters(scope.counters);
+    }
+    scope.ticks = instrument_ticks();
+    scope.nanoseconds = instrument_now();
+    return scope;
+}
+
+void instrument_end(instrument_scope_t *const scope)
+{
+    const uint64_t nanoseconds = instrument_now() - scope->nanoseconds;
+    const uint64_t ticks = instrument_ticks() - scope->ticks;
+    if ((size_t) scope->phase >= INSTRUMENT_PHASE_COUNT)
+    {
+        return;
+    }
+
+    instrument_totals_t *phase = &totals[scope->phase];
+    uint64_t counters[INSTRUMENT_COUNTER_COUNT];
+    if (scope->counting && read_counters(counters))
+    {
+        for (size_t i = 0; i < INSTRUMENT_COUNTER_COUNT; ++i)
+        {
+            atomic_fetch_add_explicit(&phase->counters[i], counters[i] - scope->counters[i], memory_order_relaxed);
+        }
+        atomic_fetch_add_explicit(&phase->counted_calls, 1, memory_order_relaxed);
+    }
+    atomic_fetch_add_explicit(&phase->calls, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&phase->nanoseconds, nanoseconds, memory_order_relaxed);
+    atomic_fetch_add_explicit(&phase->ticks, ticks, memory_order_relaxed);
+}
+
+bool instrument_set_counters(const bool enabled)
+{
+    atomic_store(&counters_enabled, enabled);
+    if (!enabled || counter_group >= 0)
+    {
+        return true;
+    }
+    return counter_group == -1 && open_counter_group();
+}
+
+void instrument_thread_exit(void)
+{
+    if (counter_group >= 0)
+    {
+        for (size_t i = INSTRUMENT_COUNTER_COUNT; i--;)
+        {
+            close(counter_fds[i]);
+        }
+    }
+    counter_group = -1;
+}
+
+bool instrument_snapshot(const instrument_phase_t phase, instrument_stats_t *const stats)
+{
+    if ((size_t) phase >= INSTRUMENT_PHASE_COUNT || !stats)
+    {
+        return false;
+    }
+    instrument_totals_t *source = &totals[phase];
+    stats->calls = atomic_load(&source->calls);
+    stats->nanoseconds = atomic_load(&source->nanoseconds);
+    stats->ticks = atomic_load(&source->ticks);
+    stats->counted_calls = atomic_load(&source->counted_calls);
+    for (size_t i = 0; i < INSTRUMENT_COUNTER_COUNT; ++i)
+    {
+        stats->counters[i] = atomic_load(&source->counters[i]);
+    }
+    return true;
+}
+
+void instrument_reset(void)
+{
+    for (size_t phase = 0; phase < INSTRUMENT_PHASE_COUNT; ++phase)
+    {
+        atomic_store(&totals[phase].calls, 0);
+        atomic_store(&totals[phase].nanoseconds, 0);
+        atomic_store(&totals[phase].ticks, 0);
+        atomic_store(&totals[phase].counted_calls, 0);
+        for (size_t i = 0; i < INSTRUMENT_COUNTER_COUNT; ++i)
+        {
+            atomic_store(&totals[phase].counters[i], 0);
+        }
+    }
+}
+
+const char *instrument_phase_name(const instrument_phase_t phase)
+{
+    if ((size_t) phase < INSTRUMENT_PHASE_COUNT)
+    {
+        return phase_names[phase];
+    }
+    return NULL;
+}
+
+const char *instrument_counter_name(const instrument_counter_t counter)
+{
+    if ((size_t) counter < INSTRUMENT_COUNTER_COUNT)
+    {
+        return counter_names[counter];
+    }
+    return NULL;
+}
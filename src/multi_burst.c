@@ -0,0 +1,369 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "dyn_array.h"
+#include "instrumentation.h"
+#include "multi_burst.h"
+#include "pcb_table.h"
+#include "sched_util.h"
+#include "timer_wheel.h"
+
+// Marks the CPU with nothing on it
+#define NO_JOB UINT32_MAX
+
+typedef struct
+{
+    PcbTable_t table;           // working copy of the ready queue, stored back only on success
+    CompactPcb_t *pcbs;
+    size_t job_count;
+    const size_t *offsets;
+    const uint32_t *bursts;
+    size_t quantum;
+    unsigned long switch_cost;
+
+    timer_wheel_t *blocked;     // PCBs waiting on I/O, keyed on completion time
+    size_t *burst_index;        // current burst of each PCB in the pool
+    uint64_t *ready_since;      // when each PCB last joined the ready queue
+
+    uint32_t *fifo;             // ready queue, a ring of PCB indices (each PCB is in it at most once)
+    size_t fifo_head;
+    size_t fifo_size;
+
+    const uint64_t *arrival_order;
+    size_t next_arrival;
+
+    uint32_t running;
+    uint32_t last_job;
+    uint64_t slice_start;
+    uint64_t slice_end;
+
+    uint64_t now;
+    size_t completed;
+    double total_waiting_time;
+    double total_turnaround_time;
+    unsigned long cpu_bursts;
+    unsigned long io_bursts;
+    unsigned long cpu_busy_time;
+    unsigned long io_time;
+    unsigned long context_switches;
+    unsigned long switch_overhead;
+}
+MultiBurstSim_t;
+
+static void make_ready(MultiBurstSim_t *sim, const uint32_t job, const uint64_t time)
+{
+    sim->fifo[(sim->fifo_head + sim->fifo_size++) % sim->job_count] = job;
+    sim->ready_since[job] = time;
+}
+
+// I/O done, on to the next CPU burst
+static void wake(MultiBurstSim_t *sim, const uint32_t job, const uint64_t time)
+{
+    ++sim->io_bursts;
+    sim->pcbs[job].remaining_burst_time = sim->bursts[++sim->burst_index[job]];
+    make_ready(sim, job, time);
+}
+
+// Admits every arrival before (or, if inclusive, at) time
+static void admit_arrivals(MultiBurstSim_t *sim, const uint64_t time, const bool inclusive)
+{
+    while (sim->next_arrival < sim->job_count) {
+        const uint64_t arrival = sim->arrival_order[sim->next_arrival] >> 32;
+        if (arrival > time || (arrival == time && !inclusive)) {
+            break;
+        }
+        make_ready(sim, (uint32_t) sim->arrival_order[sim->next_arrival], arrival);
+        ++sim->next_arrival;
+    }
+}
+
+// Brings the ready queue up to date with everything that happened up to time, in time order
+// (I/O completions before arrivals at the same instant)
+// If stop_when_ready, stops at the first instant something becomes ready and returns that time
+static uint64_t advance_to(MultiBurstSim_t *sim, const uint64_t time, const bool stop_when_ready)
+{
+    uint64_t expiry;
+    uint64_t job;
+    while (timer_wheel_pop(sim->blocked, time, &expiry, &job)) {
+        admit_arrivals(sim, expiry, false);
+        wake(sim, (uint32_t) job, expiry);
+        // finish off everything else at this instant before stopping
+        while (timer_wheel_pop(sim->blocked, expiry, NULL, &job)) {
+            wake(sim, (uint32_t) job, expiry);
+        }
+        if (stop_when_ready) {
+            return expiry;
+        }
+    }
+    admit_arrivals(sim, time, true);
+    return time;
+}
+
+// Takes the running PCB off the CPU at the current time
+// requeue is set to the PCB if it was preempted with CPU work left, NO_JOB if it blocked or finished
+// Returns false only if the PCB's I/O timer couldn't be inserted
+static bool retire(MultiBurstSim_t *sim, uint32_t *requeue)
+{
+    const uint32_t job = sim->running;
+    CompactPcb_t *pcb = &sim->pcbs[job];
+    pcb->remaining_burst_time -= (uint32_t) (sim->now - sim->slice_start);
+    sim->running = NO_JOB;
+    *requeue = NO_JOB;
+    if (pcb->remaining_burst_time) {
+        *requeue = job;
+        return true;
+    }
+
+    ++sim->cpu_bursts;
+    size_t index = ++sim->burst_index[job];
+    if (index == sim->offsets[job + 1]) {
+        ++sim->completed;
+        sim->total_turnaround_time += (double) (sim->now - pcb->arrival);
+        return true;
+    }
+
+    // Next up is I/O, zero-length I/O goes straight back to the ready queue
+    const uint32_t io = sim->bursts[index];
+    sim->io_time += io;
+    if (io == 0) {
+        wake(sim, job, sim->now);
+        return true;
+    }
+    return timer_wheel_insert(sim->blocked, sim->now + io, job, NULL);
+}
+
+static void dispatch(MultiBurstSim_t *sim)
+{
+    const uint32_t job = sim->fifo[sim->fifo_head];
+    sim->fifo_head = (sim->fifo_head + 1) % sim->job_count;
+    --sim->fifo_size;
+
+    CompactPcb_t *pcb = &sim->pcbs[job];
+    pcb_table_start(&sim->table, job);
+    sim->total_waiting_time += (double) (sim->now - sim->ready_since[job]);
+
+    uint64_t cost = 0;
+    if (sim->last_job != NO_JOB && sim->last_job != job) {
+        cost = sim->switch_cost;
+        ++sim->context_switches;
+        sim->switch_overhead += cost;
+    }
+    sim->last_job = job;
+
+    uint64_t slice = pcb->remaining_burst_time;
+    if (sim->quantum && slice > sim->quantum) {
+        slice = sim->quantum;
+    }
+    sim->running = job;
+    sim->slice_start = sim->now + cost;
+    sim->slice_end = sim->slice_start + slice;
+    sim->cpu_busy_time += (unsigned long) (cost + slice);
+}
+
+static bool run_simulation(MultiBurstSim_t *sim)
+{
+    INSTRUMENT_SCOPE(INSTRUMENT_SCHEDULE);
+    while (sim->completed < sim->job_count) {
+        if (sim->running != NO_JOB) {
+            sim->now = sim->slice_end;
+        } else if (sim->fifo_size == 0) {
+            // Idle until the next arrival, or an I/O completion if one comes first
+            uint64_t next = UINT64_MAX;
+            if (sim->next_arrival < sim->job_count) {
+                next = sim->arrival_order[sim->next_arrival] >> 32;
+            }
+            sim->now = advance_to(sim, next, true);
+        }
+
+        uint32_t requeue = NO_JOB;
+        if (sim->running != NO_JOB && !retire(sim, &requeue)) {
+            return false;
+        }
+        advance_to(sim, sim->now, false);
+
+        // Whatever became ready during the slice goes ahead of the preempted PCB
+        if (requeue != NO_JOB) {
+            make_ready(sim, requeue, sim->now);
+        }
+        if (sim->fifo_size) {
+            dispatch(sim);
+        }
+    }
+    return true;
+}
+
+BurstPool_t *burst_pool_create(void)
+{
+    BurstPool_t *pool = (BurstPool_t *) malloc(sizeof(BurstPool_t));
+    if (pool == NULL) {
+        return NULL;
+    }
+    pool->offsets = dyn_array_create(0, sizeof(size_t), NULL);
+    pool->bursts = dyn_array_create(0, sizeof(uint32_t), NULL);
+    const size_t start = 0;
+    if (pool->offsets && pool->bursts && dyn_array_push_back(pool->offsets, &start)) {
+        return pool;
+    }
+    burst_pool_destroy(pool);
+    return NULL;
+}
+
+void burst_pool_destroy(BurstPool_t *pool)
+{
+    if (pool) {
+        dyn_array_destroy(pool->offsets);
+        dyn_array_destroy(pool->bursts);
+        free(pool);
+    }
+}
+
+bool burst_pool_append(BurstPool_t *pool, const uint32_t *bursts, size_t count)
+{
+    if (pool == NULL || bursts == NULL || count % 2 == 0) {
+        return false;
+    }
+    for (size_t i = 0; i < count; i += 2) {
+        if (bursts[i] == 0) {
+            return false;
+        }
+    }
+
+    const size_t start = dyn_array_size(pool->bursts);
+    if (!dyn_array_append(pool->bursts, bursts, count)) {
+        return false;
+    }
+    const size_t end = start + count;
+    if (!dyn_array_push_back(pool->offsets, &end)) {
+        dyn_array_erase_range(pool->bursts, start, count);
+        return false;
+    }
+    return true;
+}
+
+size_t burst_pool_size(const BurstPool_t *pool)
+{
+    if (pool) {
+        return dyn_array_size(pool->offsets) - 1;
+    }
+    return 0;
+}
+
+dyn_array_t *load_multi_burst_trace(const char *input_file, BurstPool_t **pool)
+{
+    INSTRUMENT_SCOPE(INSTRUMENT_LOAD);
+    if (input_file == NULL || pool == NULL) {
+        return NULL;
+    }
+    FILE *file = fopen(input_file, "rb");
+    if (file == NULL) {
+        return NULL;
+    }
+
+    dyn_array_t *ready_queue = dyn_array_create(0, sizeof(ProcessControlBlock_t), NULL);
+    BurstPool_t *bursts = burst_pool_create();
+    dyn_array_t *scratch = dyn_array_create(0, sizeof(uint32_t), NULL);
+    bool success = ready_queue && bursts && scratch;
+
+    uint32_t header[3];     // arrival, priority, burst count
+    while (success && fread(header, sizeof(uint32_t), 3, file) == 3) {
+        // read the record's bursts into scratch, then hand them to the pool in one go
+        dyn_array_clear(scratch);
+        for (uint32_t i = 0; success && i < header[2]; ++i) {
+            uint32_t burst;
+            success = fread(&burst, sizeof(uint32_t), 1, file) == 1 && dyn_array_push_back(scratch, &burst);
+        }
+        success = success && header[2] && burst_pool_append(bursts, dyn_array_front(scratch), header[2]);
+
+        ProcessControlBlock_t pcb = {0, header[1], header[0], false};
+        if (success) {
+            pcb.remaining_burst_time = *(const uint32_t *) dyn_array_front(scratch);
+            success = dyn_array_push_back(ready_queue, &pcb);
+        }
+    }
+    // A partial record or an empty file is a bad trace
+    success = success && feof(file) && !ferror(file) && !dyn_array_empty(ready_queue);
+    fclose(file);
+    dyn_array_destroy(scratch);
+
+    if (!success) {
+        dyn_array_destroy(ready_queue);
+        burst_pool_destroy(bursts);
+        return NULL;
+    }
+    *pool = bursts;
+    return ready_queue;
+}
+
+bool multi_burst_schedule(dyn_array_t *ready_queue, const BurstPool_t *pool, size_t quantum,
+                          MultiBurstResult_t *result)
+{
+    if (ready_queue == NULL || pool == NULL || result == NULL || dyn_array_empty(ready_queue)
+        || dyn_array_size(ready_queue) != burst_pool_size(pool) || dyn_array_size(ready_queue) >= NO_JOB) {
+        return false;
+    }
+
+    const size_t job_count = dyn_array_size(ready_queue);
+    MultiBurstSim_t sim;
+    memset(&sim, 0, sizeof(MultiBurstSim_t));
+    if (!pcb_table_load(&sim.table, ready_queue)) {
+        return false;
+    }
+    sim.pcbs = sim.table.pcbs;
+    sim.job_count = job_count;
+    sim.offsets = (const size_t *) dyn_array_front(pool->offsets);
+    sim.bursts = (const uint32_t *) dyn_array_front(pool->bursts);
+    sim.quantum = quantum;
+    sim.switch_cost = get_context_switch_cost();
+    sim.running = NO_JOB;
+    sim.last_job = NO_JOB;
+
+    uint64_t *arrival_order = (uint64_t *) malloc(job_count * sizeof(uint64_t));
+    sim.blocked = timer_wheel_create(0, 0);
+    sim.burst_index = (size_t *) malloc(job_count * sizeof(size_t));
+    sim.ready_since = (uint64_t *) malloc(job_count * sizeof(uint64_t));
+    sim.fifo = (uint32_t *) malloc(job_count * sizeof(uint32_t));
+    bool success = arrival_order && sim.blocked && sim.burst_index && sim.ready_since && sim.fifo;
+
+    if (success) {
+        // Every PCB starts on its first CPU burst, whatever the PCB says
+        for (size_t i = 0; i < job_count; ++i) {
+            sim.burst_index[i] = sim.offsets[i];
+            sim.pcbs[i].remaining_burst_time = sim.bursts[sim.offsets[i]];
+            sim.table.started[i / 64] &= ~((uint64_t) 1 << (i % 64));
+            arrival_order[i] = ((uint64_t) sim.pcbs[i].arrival << 32) | i;
+        }
+        {
+            INSTRUMENT_SCOPE(INSTRUMENT_SORT);
+            qsort(arrival_order, job_count, sizeof(uint64_t), compare_u64);
+        }
+        sim.arrival_order = arrival_order;
+
+        success = run_simulation(&sim);
+    }
+
+    if (success) {
+        memset(result, 0, sizeof(MultiBurstResult_t));
+        result->schedule.average_waiting_time = (float) (sim.total_waiting_time / job_count);
+        result->schedule.average_turnaround_time = (float) (sim.total_turnaround_time / job_count);
+        result->schedule.total_run_time = (unsigned long) sim.now;
+        result->schedule.context_switches = sim.context_switches;
+        result->schedule.switch_overhead = sim.switch_overhead;
+        result->cpu_bursts = sim.cpu_bursts;
+        result->io_bursts = sim.io_bursts;
+        result->cpu_busy_time = sim.cpu_busy_time;
+        result->io_time = sim.io_time;
+        if (sim.now) {
+            result->cpu_utilization = (float) sim.cpu_busy_time / (float) sim.now;
+            result->average_io_in_flight = (float) sim.io_time / (float) sim.now;
+        }
+        pcb_table_store(&sim.table, ready_queue);
+    }
+
+    free(sim.fifo);
+    free(sim.ready_since);
+    free(sim.burst_index);
+    timer_wheel_destroy(sim.blocked);
+    free(arrival_order);
+    pcb_table_release(&sim.table);
+    return success;
+}
@@ -0,0 +1,576 @@
+#include <string.h>
+
+#include "dyn_array.h"
+#include "instrumentation.h"
+#include "multicore_scheduling.h"
+#include "pcb_table.h"
+#include "priority_queue.h"
+#include "sched_util.h"
+#include "timer_wheel.h"
+
+// Marks a CPU with nothing on it
+#define CPU_IDLE UINT32_MAX
+// Marks a PCB that hasn't been tied to a CPU yet
+#define CPU_NONE UINT16_MAX
+
+// Run queue: a ring deque of PCB indices for the FIFO policies, a heap for the keyed ones
+// Either way the owner takes from the front and thieves take from the back
+typedef struct
+{
+    priority_queue_t *heap;     // SJF, SRTF, priority
+    uint32_t *ring;             // FCFS, RR
+    size_t head;
+    size_t count;
+    size_t capacity;            // always a power of two
+}
+RunQueue_t;
+
+typedef struct
+{
+    uint32_t job;               // index of the running PCB, CPU_IDLE if none
+    uint32_t last_job;          // PCB that had this CPU last, CPU_IDLE if it never ran one
+    uint64_t dispatch_time;     // time the PCB was put on the CPU
+    uint64_t slice_start;       // time the PCB actually starts making progress (after switch and migration cost)
+    uint64_t timer;             // slice-end timer, cancelled if the slice is cut short
+    unsigned long busy_time;    // total time spent running PCBs (including switch and migration cost)
+}
+VirtualCpu_t;
+
+typedef struct
+{
+    PcbTable_t table;           // compact copy of the ready queue, written back at the end
+    CompactPcb_t *pcbs;         // table.pcbs
+    size_t job_count;
+    const MulticoreConfig_t *config;
+
+    VirtualCpu_t *cpus;
+    size_t idle_cpus;
+    uint16_t *job_cpu;          // CPU each PCB last ran on (or was queued for), CPU_NONE if neither
+
+    RunQueue_t *queues;         // one shared queue, or one per CPU
+    size_t queue_count;
+    size_t next_queue;          // where the next arrival gets dealt to (QUEUE_PER_CPU)
+
+    timer_wheel_t *events;      // slice ends, the timer value is the CPU index
+
+    uint32_t *preempted;        // PCBs knocked off a CPU this instant, waiting to be requeued
+    size_t *preempted_cpu;
+    size_t preempted_count;
+
+    uint64_t now;
+    size_t completed;
+    uint64_t *turnarounds;      // per-PCB turnaround, in completion order
+    double total_waiting_time;
+    double total_turnaround_time;
+    unsigned long steals;
+    unsigned long migrations;
+    unsigned long migration_time;
+    unsigned long context_switches;
+    unsigned long switch_time;
+    uint64_t rng_state;
+}
+MulticoreSim_t;
+
+// Event-driven replacement for virtual_cpu(), runs the pcb for a whole slice at once
+static void virtual_cpu_run(CompactPcb_t *process_control_block, uint64_t ticks)
+{
+    process_control_block->remaining_burst_time -= (uint32_t) ticks;
+}
+
+// xorshift64*, plenty for picking steal victims
+static uint64_t next_random(MulticoreSim_t *sim)
+{
+    sim->rng_state ^= sim->rng_state >> 12;
+    sim->rng_state ^= sim->rng_state << 25;
+    sim->rng_state ^= sim->rng_state >> 27;
+    return sim->rng_state * 0x2545F4914F6CDD1DULL;
+}
+
+static bool policy_is_fifo(const SchedulePolicy_t policy)
+{
+    return policy == POLICY_FCFS || policy == POLICY_RR;
+}
+
+// Ready queue key for a PCB under the configured policy
+static uint64_t ready_key(const MulticoreSim_t *sim, const uint32_t job)
+{
+    const CompactPcb_t *pcb = &sim->pcbs[job];
+    switch (sim->config->policy) {
+        case POLICY_SJF:
+        case POLICY_SRTF:
+            return pcb->remaining_burst_time;
+        case POLICY_PRIORITY:
+            return pcb->priority;
+        default:
+            return 0;
+    }
+}
+
+static bool run_queue_init(RunQueue_t *queue, const bool fifo, const size_t capacity)
+{
+    memset(queue, 0, sizeof(RunQueue_t));
+    if (fifo) {
+        queue->capacity = 16;
+        while (queue->capacity < capacity) {
+            queue->capacity <<= 1;
+        }
+        queue->ring = (uint32_t *) malloc(queue->capacity * sizeof(uint32_t));
+        return queue->ring != NULL;
+    }
+    queue->heap = priority_queue_create(capacity);
+    return queue->heap != NULL;
+}
+
+static void run_queue_destroy(RunQueue_t *queue)
+{
+    priority_queue_destroy(queue->heap);
+    free(queue->ring);
+}
+
+static size_t run_queue_size(const RunQueue_t *queue)
+{
+    return queue->heap ? priority_queue_size(queue->heap) : queue->count;
+}
+
+static bool run_queue_push(const MulticoreSim_t *sim, RunQueue_t *queue, const uint32_t job)
+{
+    if (queue->heap) {
+        return priority_queue_push(queue->heap, ready_key(sim, job), job);
+    }
+    if (queue->count == queue->capacity) {
+        // grow and unwrap so head is back at 0
+        uint32_t *ring = (uint32_t *) malloc(queue->capacity * 2 * sizeof(uint32_t));
+        if (ring == NULL) {
+            return false;
+        }
+        for (size_t i = 0; i < queue->count; ++i) {
+            ring[i] = queue->ring[(queue->head + i) & (queue->capacity - 1)];
+        }
+        free(queue->ring);
+        queue->ring = ring;
+        queue->head = 0;
+        queue->capacity <<= 1;
+    }
+    queue->ring[(queue->head + queue->count) & (queue->capacity - 1)] = job;
+    ++queue->count;
+    return true;
+}
+
+static bool run_queue_pop_front(RunQueue_t *queue, uint32_t *job)
+{
+    if (queue->heap) {
+        pq_entry_t entry;
+        if (priority_queue_pop(queue->heap, &entry)) {
+            *job = (uint32_t) entry.value;
+            return true;
+        }
+        return false;
+    }
+    if (queue->count) {
+        *job = queue->ring[queue->head];
+        queue->head = (queue->head + 1) & (queue->capacity - 1);
+        --queue->count;
+        return true;
+    }
+    return false;
+}
+
+// Key of the next PCB out of the queue, only meaningful for the keyed policies
+static uint64_t run_queue_top_key(const RunQueue_t *queue)
+{
+    const pq_entry_t *top = priority_queue_top(queue->heap);
+    return top ? top->key : UINT64_MAX;
+}
+
+// Moves count PCBs off the back of one queue onto another
+static bool run_queue_move_tail(const MulticoreSim_t *sim, RunQueue_t *from, RunQueue_t *to, const size_t count)
+{
+    if (from->heap) {
+        pq_entry_t entry;
+        for (size_t i = 0; i < count; ++i) {
+            if (!priority_queue_pop_back(from->heap, &entry) || !run_queue_push(sim, to, (uint32_t) entry.value)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    // keep the stolen batch in its original order
+    const size_t first = from->count - count;
+    for (size_t i = 0; i < count; ++i) {
+        if (!run_queue_push(sim, to, from->ring[(from->head + first + i) & (from->capacity - 1)])) {
+            return false;
+        }
+    }
+    from->count = first;
+    return true;
+}
+
+static RunQueue_t *cpu_queue(const MulticoreSim_t *sim, const size_t cpu)
+{
+    return sim->queue_count == 1 ? &sim->queues[0] : &sim->queues[cpu];
+}
+
+// Puts a job on a CPU for as long as the policy lets it run uninterrupted
+static bool dispatch(MulticoreSim_t *sim, const size_t cpu_idx, const uint32_t job)
+{
+    VirtualCpu_t *cpu = &sim->cpus[cpu_idx];
+    CompactPcb_t *pcb = &sim->pcbs[job];
+
+    if (pcb_table_start(&sim->table, job)) {
+        sim->total_waiting_time += (double) (sim->now - pcb->arrival);
+    }
+
+    // Handing the CPU to a different PCB costs the fixed switch, landing on a new CPU also costs the warmup
+    uint64_t penalty = 0;
+    if (cpu->last_job != CPU_IDLE && cpu->last_job != job) {
+        penalty = sim->config->switch_cost;
+        ++sim->context_switches;
+        sim->switch_time += penalty;
+    }
+    cpu->last_job = job;
+    if (sim->job_cpu[job] != CPU_NONE && sim->job_cpu[job] != cpu_idx) {
+        penalty += sim->config->migration_cost;
+        ++sim->migrations;
+        sim->migration_time += sim->config->migration_cost;
+    }
+    sim->job_cpu[job] = (uint16_t) cpu_idx;
+
+    uint64_t slice = pcb->remaining_burst_time;
+    if (sim->config->policy == POLICY_RR && slice > sim->config->quantum) {
+        slice = sim->config->quantum;
+    }
+
+    cpu->job = job;
+    cpu->dispatch_time = sim->now;
+    cpu->slice_start = sim->now + penalty;
+    --sim->idle_cpus;
+    return timer_wheel_insert(sim->events, cpu->slice_start + slice, cpu_idx, &cpu->timer);
+}
+
+// Time the job on the CPU has made progress this slice, as of now
+static uint64_t slice_progress(const MulticoreSim_t *sim, const VirtualCpu_t *cpu)
+{
+    return sim->now > cpu->slice_start ? sim->now - cpu->slice_start : 0;
+}
+
+// Takes the job off a CPU at the current time, crediting it with the time it ran
+// Returns the job if it still has work left, CPU_IDLE if it completed
+static uint32_t retire(MulticoreSim_t *sim, const size_t cpu_idx)
+{
+    VirtualCpu_t *cpu = &sim->cpus[cpu_idx];
+    CompactPcb_t *pcb = &sim->pcbs[cpu->job];
+    const uint32_t job = cpu->job;
+
+    // no-op if the slice ran out, its timer already fired
+    timer_wheel_cancel(sim->events, cpu->timer);
+    virtual_cpu_run(pcb, slice_progress(sim, cpu));
+    cpu->busy_time += sim->now - cpu->dispatch_time;
+    cpu->job = CPU_IDLE;
+    ++sim->idle_cpus;
+
+    if (pcb->remaining_burst_time == 0) {
+        sim->turnarounds[sim->completed] = sim->now - pcb->arrival;
+        sim->total_turnaround_time += (double) (sim->now - pcb->arrival);
+        ++sim->completed;
+        return CPU_IDLE;
+    }
+    return job;
+}
+
+// Picks a non-empty queue to rob according to the steal policy, NULL if everything is empty
+static RunQueue_t *steal_victim(MulticoreSim_t *sim, const size_t thief)
+{
+    const size_t count = sim->queue_count;
+
+    if (sim->config->steal_policy == STEAL_MOST_LOADED) {
+        RunQueue_t *victim = NULL;
+        size_t victim_size = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (i != thief && run_queue_size(&sim->queues[i]) > victim_size) {
+                victim = &sim->queues[i];
+                victim_size = run_queue_size(victim);
+            }
+        }
+        return victim;
+    }
+
+    // Random and neighbor only differ in where the scan starts
+    size_t start = thief + 1;
+    if (sim->config->steal_policy == STEAL_RANDOM) {
+        start = (size_t) (next_random(sim) % count);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        size_t candidate = (start + i) % count;
+        if (candidate != thief && run_queue_size(&sim->queues[candidate])) {
+            return &sim->queues[candidate];
+        }
+    }
+    return NULL;
+}
+
+// Refills an idle CPU's empty queue from the tail of somebody else's
+static bool steal_work(MulticoreSim_t *sim, const size_t thief)
+{
+    RunQueue_t *victim = steal_victim(sim, thief);
+    if (victim == NULL) {
+        return true;
+    }
+    size_t amount = 1;
+    if (sim->config->steal_half && run_queue_size(victim) > 1) {
+        amount = run_queue_size(victim) / 2;
+    }
+    sim->steals += amount;
+    return run_queue_move_tail(sim, victim, &sim->queues[thief], amount);
+}
+
+// Hands work to every idle CPU that can get some
+static bool dispatch_idle_cpus(MulticoreSim_t *sim)
+{
+    for (size_t i = 0; i < sim->config->cpu_count && sim->idle_cpus; ++i) {
+        if (sim->cpus[i].job != CPU_IDLE) {
+            continue;
+        }
+        RunQueue_t *queue = cpu_queue(sim, i);
+        if (run_queue_size(queue) == 0 && sim->config->work_stealing && sim->queue_count > 1
+            && !steal_work(sim, i)) {
+            return false;
+        }
+        uint32_t job;
+        if (run_queue_pop_front(queue, &job) && !dispatch(sim, i, job)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Remaining time of whatever is on the CPU, as of now
+static uint64_t running_remaining(const MulticoreSim_t *sim, const size_t cpu_idx)
+{
+    const VirtualCpu_t *cpu = &sim->cpus[cpu_idx];
+    return sim->pcbs[cpu->job].remaining_burst_time - slice_progress(sim, cpu);
+}
+
+// Swaps the job on a CPU for a shorter one waiting in its queue
+static bool preempt_with(MulticoreSim_t *sim, const size_t cpu_idx, RunQueue_t *queue)
+{
+    uint32_t next_job;
+    const uint32_t job = retire(sim, cpu_idx);
+    return run_queue_pop_front(queue, &next_job) && run_queue_push(sim, queue, job)
+           && dispatch(sim, cpu_idx, next_job);
+}
+
+// SRTF: keep preempting while something queued is shorter than something running
+static bool preempt_longer_jobs(MulticoreSim_t *sim)
+{
+    if (sim->queue_count == 1) {
+        RunQueue_t *queue = &sim->queues[0];
+        while (run_queue_size(queue)) {
+            size_t longest_cpu = 0;
+            uint64_t longest = 0;
+            for (size_t i = 0; i < sim->config->cpu_count; ++i) {
+                if (sim->cpus[i].job != CPU_IDLE && running_remaining(sim, i) > longest) {
+                    longest = running_remaining(sim, i);
+                    longest_cpu = i;
+                }
+            }
+            if (run_queue_top_key(queue) >= longest) {
+                break;
+            }
+            if (!preempt_with(sim, longest_cpu, queue)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    for (size_t i = 0; i < sim->config->cpu_count; ++i) {
+        RunQueue_t *queue = &sim->queues[i];
+        if (sim->cpus[i].job != CPU_IDLE && run_queue_size(queue)
+            && run_queue_top_key(queue) < running_remaining(sim, i)) {
+            if (!preempt_with(sim, i, queue)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool run_simulation(MulticoreSim_t *sim, const uint64_t *arrival_order)
+{
+    const size_t cpu_count = sim->config->cpu_count;
+    size_t next_arrival = 0;
+
+    INSTRUMENT_SCOPE(INSTRUMENT_SCHEDULE);
+    while (sim->completed < sim->job_count) {
+        // Jump straight to the next thing that happens
+        uint64_t next = UINT64_MAX;
+        timer_wheel_peek(sim->events, &next);
+        if (next_arrival < sim->job_count) {
+            uint64_t arrival = arrival_order[next_arrival] >> 32;
+            if (arrival < next) {
+                next = arrival;
+            }
+        }
+        if (next == UINT64_MAX) {
+            return false;   // queued work with no CPU able to take it
+        }
+        if (next > sim->now) {
+            sim->now = next;
+        }
+
+        // Slices ending now
+        sim->preempted_count = 0;
+        uint64_t cpu_idx;
+        while (timer_wheel_pop(sim->events, sim->now, NULL, &cpu_idx)) {
+            uint32_t job = retire(sim, (size_t) cpu_idx);
+            if (job != CPU_IDLE) {
+                sim->preempted[sim->preempted_count] = job;
+                sim->preempted_cpu[sim->preempted_count] = cpu_idx;
+                ++sim->preempted_count;
+            }
+        }
+
+        // Arrivals go ahead of jobs whose quantum just expired
+        while (next_arrival < sim->job_count && (arrival_order[next_arrival] >> 32) <= sim->now) {
+            uint32_t job = (uint32_t) arrival_order[next_arrival];
+            if (sim->queue_count > 1) {
+                sim->job_cpu[job] = (uint16_t) sim->next_queue;
+            }
+            if (!run_queue_push(sim, &sim->queues[sim->next_queue], job)) {
+                return false;
+            }
+            sim->next_queue = (sim->next_queue + 1) % sim->queue_count;
+            ++next_arrival;
+        }
+        for (size_t i = 0; i < sim->preempted_count; ++i) {
+            if (!run_queue_push(sim, cpu_queue(sim, sim->preempted_cpu[i]), sim->preempted[i])) {
+                return false;
+            }
+        }
+
+        if (!dispatch_idle_cpus(sim)) {
+            return false;
+        }
+        if (sim->config->policy == POLICY_SRTF && sim->idle_cpus < cpu_count && !preempt_longer_jobs(sim)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void fill_result(MulticoreSim_t *sim, MulticoreResult_t *result)
+{
+    memset(result, 0, sizeof(MulticoreResult_t));
+
+    result->schedule.average_waiting_time = (float) (sim->total_waiting_time / sim->job_count);
+    result->schedule.average_turnaround_time = (float) (sim->total_turnaround_time / sim->job_count);
+    result->schedule.total_run_time = (unsigned long) sim->now;
+    result->schedule.context_switches = sim->context_switches;
+    result->schedule.switch_overhead = sim->switch_time + sim->migration_time;
+    result->cpu_count = sim->config->cpu_count;
+    result->steals = sim->steals;
+    result->migrations = sim->migrations;
+    result->migration_time = sim->migration_time;
+
+    unsigned long total_busy = 0;
+    unsigned long max_busy = 0;
+    for (size_t i = 0; i < sim->config->cpu_count; ++i) {
+        unsigned long busy = sim->cpus[i].busy_time;
+        result->cpu_busy_time[i] = busy;
+        result->cpu_utilization[i] = sim->now ? (float) busy / (float) sim->now : 0.0f;
+        total_busy += busy;
+        if (busy > max_busy) {
+            max_busy = busy;
+        }
+    }
+    if (total_busy) {
+        double mean_busy = (double) total_busy / sim->config->cpu_count;
+        result->load_imbalance = (float) (max_busy / mean_busy - 1.0);
+    }
+
+    qsort(sim->turnarounds, sim->job_count, sizeof(uint64_t), compare_u64);
+    result->turnaround_p50 = percentile(sim->turnarounds, sim->job_count, 50);
+    result->turnaround_p95 = percentile(sim->turnarounds, sim->job_count, 95);
+    result->turnaround_p99 = percentile(sim->turnarounds, sim->job_count, 99);
+    result->turnaround_max = (unsigned long) sim->turnarounds[sim->job_count - 1];
+}
+
+bool multicore_schedule(dyn_array_t *ready_queue, const MulticoreConfig_t *config, MulticoreResult_t *result)
+{
+    if (ready_queue == NULL || config == NULL || result == NULL || dyn_array_empty(ready_queue)
+        || dyn_array_data_size(ready_queue) != sizeof(ProcessControlBlock_t)) {
+        return false;
+    }
+    if (config->cpu_count == 0 || config->cpu_count > MULTICORE_MAX_CPUS
+        || (config->policy == POLICY_RR && config->quantum == 0)
+        || dyn_array_size(ready_queue) >= CPU_IDLE) {
+        return false;
+    }
+
+    const size_t job_count = dyn_array_size(ready_queue);
+    const size_t cpu_count = config->cpu_count;
+
+    MulticoreSim_t sim;
+    memset(&sim, 0, sizeof(MulticoreSim_t));
+    if (!pcb_table_load(&sim.table, ready_queue)) {
+        return false;
+    }
+    sim.pcbs = sim.table.pcbs;
+    sim.job_count = job_count;
+    sim.config = config;
+    sim.idle_cpus = cpu_count;
+    sim.queue_count = config->queue_mode == QUEUE_PER_CPU ? cpu_count : 1;
+    sim.rng_state = config->steal_seed ? config->steal_seed : 0x9E3779B97F4A7C15ULL;
+
+    uint64_t *arrival_order = (uint64_t *) malloc(job_count * sizeof(uint64_t));
+    sim.turnarounds = (uint64_t *) malloc(job_count * sizeof(uint64_t));
+    sim.job_cpu = (uint16_t *) malloc(job_count * sizeof(uint16_t));
+    sim.cpus = (VirtualCpu_t *) calloc(cpu_count, sizeof(VirtualCpu_t));
+    sim.queues = (RunQueue_t *) calloc(sim.queue_count, sizeof(RunQueue_t));
+    sim.preempted = (uint32_t *) malloc(cpu_count * sizeof(uint32_t));
+    sim.preempted_cpu = (size_t *) malloc(cpu_count * sizeof(size_t));
+    sim.events = timer_wheel_create(0, cpu_count);
+
+    bool success = arrival_order && sim.turnarounds && sim.job_cpu && sim.cpus && sim.queues && sim.preempted
+                   && sim.preempted_cpu && sim.events;
+    for (size_t i = 0; success && i < sim.queue_count; ++i) {
+        success = run_queue_init(&sim.queues[i], policy_is_fifo(config->policy),
+                                 sim.queue_count == 1 ? job_count : job_count / cpu_count);
+    }
+
+    if (success) {
+        for (size_t i = 0; i < cpu_count; ++i) {
+            sim.cpus[i].job = CPU_IDLE;
+            sim.cpus[i].last_job = CPU_IDLE;
+        }
+        // Stable arrival ordering without needing the PCBs inside the comparator
+        for (size_t i = 0; i < job_count; ++i) {
+            arrival_order[i] = ((uint64_t) sim.pcbs[i].arrival << 32) | i;
+            sim.job_cpu[i] = CPU_NONE;
+        }
+        {
+            INSTRUMENT_SCOPE(INSTRUMENT_SORT);
+            qsort(arrival_order, job_count, sizeof(uint64_t), compare_u64);
+        }
+
+        success = run_simulation(&sim, arrival_order);
+        if (success) {
+            fill_result(&sim, result);
+            pcb_table_store(&sim.table, ready_queue);
+        }
+    }
+
+    for (size_t i = 0; sim.queues && i < sim.queue_count; ++i) {
+        run_queue_destroy(&sim.queues[i]);
+    }
+    timer_wheel_destroy(sim.events);
+    free(sim.preempted_cpu);
+    free(sim.preempted);
+    free(sim.queues);
+    free(sim.cpus);
+    free(sim.job_cpu);
+    free(sim.turnarounds);
+    free(arrival_order);
+    pcb_table_release(&sim.table);
+    return success;
+}
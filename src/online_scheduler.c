@@ -0,0 +1,332 @@
+#include <limits.h>
+#include <string.h>
+
+#include "dyn_array.h"
+#include "online_scheduler.h"
+#include "priority_queue.h"
+
+#define NO_JOB UINT64_MAX
+
+typedef struct
+{
+    ProcessControlBlock_t pcb;
+    uint32_t burst_time;
+    unsigned long first_run;
+}
+OnlineJob_t;
+
+struct online_scheduler
+{
+    SchedulePolicy_t policy;
+    size_t quantum;
+    unsigned long now;
+
+    dyn_array_t *jobs;              // OnlineJob_t, indexed by job id
+    priority_queue_t *arrivals;     // submitted but not yet arrived, keyed on arrival
+    priority_queue_t *ready;        // keyed per policy, ties FIFO
+    dyn_array_t *completions;       // ScheduleCompletion_t, not yet polled
+    size_t completions_head;        // first unpolled completion
+
+    uint64_t running;               // job on the CPU, NO_JOB if idle
+    uint64_t last_job;              // job that had the CPU last, NO_JOB before the first dispatch
+    unsigned long switch_cost;      // fixed cost of a context switch, see set_context_switch_cost
+    unsigned long dispatch_time;    // time the running job was put on the CPU
+    unsigned long slice_start;      // time it starts making progress, after any switch cost
+    unsigned long slice_end;
+
+    size_t started;
+    size_t completed;
+    unsigned long busy_time;
+    unsigned long context_switches;
+    unsigned long switch_overhead;
+    double total_waiting_time;
+    double total_turnaround_time;
+};
+
+static OnlineJob_t *job_at(const online_scheduler_t *scheduler, const uint64_t job_id)
+{
+    return (OnlineJob_t *) dyn_array_at(scheduler->jobs, (size_t) job_id);
+}
+
+static uint64_t ready_key(const online_scheduler_t *scheduler, const OnlineJob_t *job)
+{
+    switch (scheduler->policy) {
+        case POLICY_SJF:
+        case POLICY_SRTF:
+            return job->pcb.remaining_burst_time;
+        case POLICY_PRIORITY:
+            return job->pcb.priority;
+        default:
+            return 0;
+    }
+}
+
+static bool make_ready(online_scheduler_t *scheduler, const uint64_t job_id)
+{
+    return priority_queue_push(scheduler->ready, ready_key(scheduler, job_at(scheduler, job_id)), job_id);
+}
+
+static bool dispatch(online_scheduler_t *scheduler, const uint64_t job_id)
+{
+    OnlineJob_t *job = job_at(scheduler, job_id);
+    if (!job->pcb.started) {
+        job->pcb.started = true;
+        job->first_run = scheduler->now;
+        ++scheduler->started;
+        scheduler->total_waiting_time += (double) (scheduler->now - job->pcb.arrival);
+    }
+
+    unsigned long slice = job->pcb.remaining_burst_time;
+    if (scheduler->policy == POLICY_RR && slice > scheduler->quantum) {
+        slice = scheduler->quantum;
+    }
+    // Only the preemptive policies pay for switches, as in the batch schedulers (see set_context_switch_cost)
+    const bool preemptive = scheduler->policy == POLICY_RR || scheduler->policy == POLICY_SRTF;
+    unsigned long cost = 0;
+    if (preemptive && scheduler->last_job != NO_JOB && scheduler->last_job != job_id) {
+        cost = scheduler->switch_cost;
+        ++scheduler->context_switches;
+        scheduler->switch_overhead += cost;
+    }
+    scheduler->last_job = job_id;
+
+    scheduler->running = job_id;
+    scheduler->dispatch_time = scheduler->now;
+    scheduler->slice_start = scheduler->now + cost;
+    scheduler->slice_end = scheduler->slice_start + slice;
+    return true;
+}
+
+// Time the running job has made progress this slice, as of now (none while it's still switching in)
+static unsigned long slice_progress(const online_scheduler_t *scheduler)
+{
+    return scheduler->now > scheduler->slice_start ? scheduler->now - scheduler->slice_start : 0;
+}
+
+// Takes the running job off the CPU at the current time
+// Returns the job id if it still has work left, NO_JOB if it completed (or on error)
+static uint64_t retire(online_scheduler_t *scheduler, bool *success)
+{
+    const uint64_t job_id = scheduler->running;
+    OnlineJob_t *job = job_at(scheduler, job_id);
+    const unsigned long ran = slice_progress(scheduler);
+
+    job->pcb.remaining_burst_time -= (uint32_t) ran;
+    scheduler->busy_time += scheduler->now - scheduler->dispatch_time;
+    scheduler->running = NO_JOB;
+
+    if (job->pcb.remaining_burst_time) {
+        return job_id;
+    }
+
+    ScheduleCompletion_t completion = {job_id, job->burst_time, job->pcb.priority, job->pcb.arrival,
+                                       job->first_run, scheduler->now};
+    ++scheduler->completed;
+    scheduler->total_turnaround_time += (double) (scheduler->now - job->pcb.arrival);
+    *success = dyn_array_push_back(scheduler->completions, &completion);
+    return NO_JOB;
+}
+
+// Everything that happens at a single instant: slice end, arrivals, requeue, preemption, dispatch
+static bool process_instant(online_scheduler_t *scheduler)
+{
+    bool success = true;
+    uint64_t requeue = NO_JOB;
+
+    if (scheduler->running != NO_JOB && scheduler->slice_end == scheduler->now) {
+        requeue = retire(scheduler, &success);
+    }
+
+    // Arrivals go ahead of a job whose quantum just expired
+    const pq_entry_t *arrival;
+    while (success && (arrival = priority_queue_top(scheduler->arrivals)) && arrival->key <= scheduler->now) {
+        pq_entry_t entry;
+        priority_queue_pop(scheduler->arrivals, &entry);
+        success = make_ready(scheduler, entry.value);
+    }
+    if (success && requeue != NO_JOB) {
+        success = make_ready(scheduler, requeue);
+    }
+
+    if (success && scheduler->policy == POLICY_SRTF && scheduler->running != NO_JOB
+        && !priority_queue_empty(scheduler->ready)) {
+        const OnlineJob_t *job = job_at(scheduler, scheduler->running);
+        uint64_t remaining = job->pcb.remaining_burst_time - slice_progress(scheduler);
+        if (priority_queue_top(scheduler->ready)->key < remaining) {
+            uint64_t preempted = retire(scheduler, &success);
+            success = success && make_ready(scheduler, preempted);
+        }
+    }
+
+    if (success && scheduler->running == NO_JOB) {
+        pq_entry_t entry;
+        if (priority_queue_pop(scheduler->ready, &entry)) {
+            success = dispatch(scheduler, entry.value);
+        }
+    }
+    return success;
+}
+
+// Time of the next thing that will happen, ULONG_MAX if nothing is pending
+static unsigned long next_event(const online_scheduler_t *scheduler)
+{
+    unsigned long next = ULONG_MAX;
+    if (scheduler->running != NO_JOB) {
+        next = scheduler->slice_end;
+    }
+    const pq_entry_t *arrival = priority_queue_top(scheduler->arrivals);
+    if (arrival && arrival->key < next) {
+        next = (unsigned long) arrival->key;
+    }
+    return next;
+}
+
+online_scheduler_t *online_scheduler_create(SchedulePolicy_t policy, size_t quantum)
+{
+    if (policy > POLICY_PRIORITY || (policy == POLICY_RR && quantum == 0)) {
+        return NULL;
+    }
+
+    online_scheduler_t *scheduler = (online_scheduler_t *) calloc(1, sizeof(online_scheduler_t));
+    if (scheduler == NULL) {
+        return NULL;
+    }
+    scheduler->policy = policy;
+    scheduler->quantum = quantum;
+    scheduler->running = NO_JOB;
+    scheduler->last_job = NO_JOB;
+    scheduler->switch_cost = get_context_switch_cost();
+    scheduler->jobs = dyn_array_create(0, sizeof(OnlineJob_t), NULL);
+    scheduler->arrivals = priority_queue_create(0);
+    scheduler->ready = priority_queue_create(0);
+    scheduler->completions = dyn_array_create(0, sizeof(ScheduleCompletion_t), NULL);
+
+    if (scheduler->jobs && scheduler->arrivals && scheduler->ready && scheduler->completions) {
+        return scheduler;
+    }
+    online_scheduler_destroy(scheduler);
+    return NULL;
+}
+
+void online_scheduler_destroy(online_scheduler_t *scheduler)
+{
+    if (scheduler) {
+        dyn_array_destroy(scheduler->jobs);
+        priority_queue_destroy(scheduler->arrivals);
+        priority_queue_destroy(scheduler->ready);
+        dyn_array_destroy(scheduler->completions);
+        free(scheduler);
+    }
+}
+
+bool online_scheduler_submit(online_scheduler_t *scheduler, const ProcessControlBlock_t *pcb, uint64_t *job_id)
+{
+    if (scheduler == NULL || pcb == NULL || pcb->arrival < scheduler->now) {
+        return false;
+    }
+
+    OnlineJob_t job = {*pcb, pcb->remaining_burst_time, 0};
+    job.pcb.started = false;
+    const uint64_t id = dyn_array_size(scheduler->jobs);
+    if (!dyn_array_push_back(scheduler->jobs, &job)) {
+        return false;
+    }
+    if (!priority_queue_push(scheduler->arrivals, pcb->arrival, id)) {
+        dyn_array_pop_back(scheduler->jobs);
+        return false;
+    }
+    if (job_id) {
+        *job_id = id;
+    }
+    return true;
+}
+
+bool online_scheduler_advance(online_scheduler_t *scheduler, unsigned long time)
+{
+    if (scheduler == NULL || time < scheduler->now) {
+        return false;
+    }
+
+    unsigned long next;
+    while ((next = next_event(scheduler)) <= time) {
+        scheduler->now = next;
+        if (!process_instant(scheduler)) {
+            return false;
+        }
+    }
+    scheduler->now = time;
+    return true;
+}
+
+bool online_scheduler_drain(online_scheduler_t *scheduler)
+{
+    if (scheduler == NULL) {
+        return false;
+    }
+
+    unsigned long next;
+    while ((next = next_event(scheduler)) != ULONG_MAX) {
+        scheduler->now = next;
+        if (!process_instant(scheduler)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t online_scheduler_poll(online_scheduler_t *scheduler, ScheduleCompletion_t *completions, size_t max_count)
+{
+    if (scheduler == NULL || completions == NULL) {
+        return 0;
+    }
+
+    size_t available = dyn_array_size(scheduler->completions) - scheduler->completions_head;
+    size_t count = available < max_count ? available : max_count;
+    if (count) {
+        memcpy(completions, dyn_array_at(scheduler->completions, scheduler->completions_head),
+               count * sizeof(ScheduleCompletion_t));
+        scheduler->completions_head += count;
+    }
+    // everything read, recycle the buffer instead of shifting it
+    if (scheduler->completions_head == dyn_array_size(scheduler->completions)) {
+        dyn_array_clear(scheduler->completions);
+        scheduler->completions_head = 0;
+    }
+    return count;
+}
+
+bool online_scheduler_snapshot(const online_scheduler_t *scheduler, OnlineStats_t *stats)
+{
+    if (scheduler == NULL || stats == NULL) {
+        return false;
+    }
+
+    memset(stats, 0, sizeof(OnlineStats_t));
+    if (scheduler->started) {
+        stats->schedule.average_waiting_time = (float) (scheduler->total_waiting_time / scheduler->started);
+    }
+    if (scheduler->completed) {
+        stats->schedule.average_turnaround_time = (float) (scheduler->total_turnaround_time / scheduler->completed);
+    }
+    stats->schedule.total_run_time = scheduler->now;
+    stats->schedule.context_switches = scheduler->context_switches;
+    stats->schedule.switch_overhead = scheduler->switch_overhead;
+    stats->submitted = dyn_array_size(scheduler->jobs);
+    stats->started = scheduler->started;
+    stats->completed = scheduler->completed;
+    stats->queued = priority_queue_size(scheduler->ready);
+    stats->busy_time = scheduler->busy_time;
+    // include the part of the current slice already run
+    if (scheduler->running != NO_JOB) {
+        stats->busy_time += scheduler->now - scheduler->dispatch_time;
+    }
+    return true;
+}
+
+unsigned long online_scheduler_now(const online_scheduler_t *scheduler)
+{
+    if (scheduler) {
+        return scheduler->now;
+    }
+    return 0;
+}
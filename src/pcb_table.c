@@ -0,0 +1,55 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "pcb_table.h"
+
+_Static_assert(sizeof(CompactPcb_t) == 12, "CompactPcb_t should be three packed uint32s");
+
+#define STARTED_WORDS(count) (((count) + 63) / 64)
+
+bool pcb_table_load(PcbTable_t *const table, const dyn_array_t *const ready_queue)
+{
+    table->pcbs = NULL;
+    table->started = NULL;
+    table->count = 0;
+    if (ready_queue == NULL || dyn_array_empty(ready_queue)
+        || dyn_array_data_size(ready_queue) != sizeof(ProcessControlBlock_t)) {
+        return false;
+    }
+
+    // Bitmap first so both parts are aligned without any padding between them
+    const size_t count = dyn_array_size(ready_queue);
+    const size_t words = STARTED_WORDS(count);
+    table->started = calloc(1, words * sizeof(uint64_t) + count * sizeof(CompactPcb_t));
+    if (table->started == NULL) {
+        return false;
+    }
+    table->pcbs = (CompactPcb_t *)(table->started + words);
+    table->count = count;
+
+    const ProcessControlBlock_t *source = dyn_array_front(ready_queue);
+    for (size_t i = 0; i < count; ++i) {
+        table->pcbs[i].remaining_burst_time = source[i].remaining_burst_time;
+        table->pcbs[i].priority = source[i].priority;
+        table->pcbs[i].arrival = source[i].arrival;
+        table->started[i / 64] |= (uint64_t)source[i].started << (i % 64);
+    }
+    return true;
+}
+
+void pcb_table_store(const PcbTable_t *const table, dyn_array_t *const ready_queue)
+{
+    ProcessControlBlock_t *destination = dyn_array_front(ready_queue);
+    for (size_t i = 0; i < table->count; ++i) {
+        destination[i].remaining_burst_time = table->pcbs[i].remaining_burst_time;
+        destination[i].started = (table->started[i / 64] >> (i % 64)) & 1;
+    }
+}
+
+void pcb_table_release(PcbTable_t *const table)
+{
+    free(table->started);
+    table->started = NULL;
+    table->pcbs = NULL;
+    table->count = 0;
+}
@@ -0,0 +1,149 @@
+#include "priority_queue.h"
+
+// Heap lives directly in the dyn_array storage, index 0 is the root
+// children of i are 2i+1 and 2i+2
+#define PQ_ENTRIES(pq_ptr) ((pq_entry_t *) (pq_ptr)->heap->array)
+
+// true iff a should come out before b
+static inline bool pq_entry_less(const pq_entry_t *const a, const pq_entry_t *const b)
+{
+    return a->key < b->key || (a->key == b->key && a->seq < b->seq);
+}
+
+static void pq_sift_up(pq_entry_t *const entries, size_t idx)
+{
+    pq_entry_t moving = entries[idx];
+    while (idx)
+    {
+        size_t parent = (idx - 1) >> 1;
+        if (!pq_entry_less(&moving, &entries[parent]))
+        {
+            break;
+        }
+        entries[idx] = entries[parent];
+        idx = parent;
+    }
+    entries[idx] = moving;
+}
+
+static void pq_sift_down(pq_entry_t *const entries, const size_t size, size_t idx)
+{
+    pq_entry_t moving = entries[idx];
+    for (;;)
+    {
+        size_t child = (idx << 1) + 1;
+        if (child >= size)
+        {
+            break;
+        }
+        if (child + 1 < size && pq_entry_less(&entries[child + 1], &entries[child]))
+        {
+            ++child;
+        }
+        if (!pq_entry_less(&entries[child], &moving))
+        {
+            break;
+        }
+        entries[idx] = entries[child];
+        idx = child;
+    }
+    entries[idx] = moving;
+}
+
+priority_queue_t *priority_queue_create(const size_t capacity)
+{
+    priority_queue_t *pq = (priority_queue_t *) malloc(sizeof(priority_queue_t));
+    if (pq)
+    {
+        pq->heap = dyn_array_create(capacity, sizeof(pq_entry_t), NULL);
+        pq->next_seq = 0;
+        if (pq->heap)
+        {
+            return pq;
+        }
+        free(pq);
+    }
+    return NULL;
+}
+
+void priority_queue_destroy(priority_queue_t *const pq)
+{
+    if (pq)
+    {
+        dyn_array_destroy(pq->heap);
+        free(pq);
+    }
+}
+
+bool priority_queue_push(priority_queue_t *const pq, const uint64_t key, const uint64_t value)
+{
+    if (pq)
+    {
+        pq_entry_t entry = {key, pq->next_seq, value};
+        if (dyn_array_push_back(pq->heap, &entry))
+        {
+            ++pq->next_seq;
+            pq_sift_up(PQ_ENTRIES(pq), dyn_array_size(pq->heap) - 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+const pq_entry_t *priority_queue_top(const priority_queue_t *const pq)
+{
+    if (pq)
+    {
+        return (const pq_entry_t *) dyn_array_front(pq->heap);
+    }
+    return NULL;
+}
+
+bool priority_queue_pop(priority_queue_t *const pq, pq_entry_t *const entry)
+{
+    if (pq && dyn_array_size(pq->heap))
+    {
+        pq_entry_t *entries = PQ_ENTRIES(pq);
+        if (entry)
+        {
+            *entry = entries[0];
+        }
+        // move the last leaf to the root and let it sink
+        size_t last = dyn_array_size(pq->heap) - 1;
+        entries[0] = entries[last];
+        dyn_array_pop_back(pq->heap);
+        if (last)
+        {
+            pq_sift_down(entries, last, 0);
+        }
+        return true;
+    }
+    return false;
+}
+
+bool priority_queue_pop_back(priority_queue_t *const pq, pq_entry_t *const entry)
+{
+    if (pq && dyn_array_size(pq->heap))
+    {
+        if (entry)
+        {
+            return dyn_array_extract_back(pq->heap, entry);
+        }
+        return dyn_array_pop_back(pq->heap);
+    }
+    return false;
+}
+
+size_t priority_queue_size(const priority_queue_t *const pq)
+{
+    if (pq)
+    {
+        return dyn_array_size(pq->heap);
+    }
+    return 0;
+}
+
+bool priority_queue_empty(const priority_queue_t *const pq)
+{
+    return priority_queue_size(pq) == 0;
+}
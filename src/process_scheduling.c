@@ -1,10 +1,17 @@
 #include <fcntl.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
 
 #include "dyn_array.h"
+#include "instrumentation.h"
+#include "pcb_table.h"
+#include "priority_queue.h"
 #include "processing_scheduling.h"
+#include "rb_tree.h"
+#include "sched_util.h"
 
 
 // You might find this handy.  I put it around unused parameters, but you should
@@ -18,6 +25,60 @@ void virtual_cpu(ProcessControlBlock_t *process_control_block)
     --process_control_block->remaining_burst_time;
 }
 
+// Builds the arrival order of the PCBs (ties in queue order) without moving the PCBs themselves
+// Each entry is arrival << 32 | index, caller frees
+static uint64_t *build_arrival_order(const CompactPcb_t *pcbs, size_t count)
+{
+    uint64_t *order = malloc(count * sizeof(uint64_t));
+    if (order == NULL) {
+        return NULL;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        order[i] = ((uint64_t)pcbs[i].arrival << 32) | i;
+    }
+    INSTRUMENT_SCOPE(INSTRUMENT_SORT);
+    qsort(order, count, sizeof(uint64_t), compare_u64);
+    return order;
+}
+
+// Time charged for every switch to a different PCB, see set_context_switch_cost
+// Atomic so a setter racing a scheduler is only a stale read, each run reads it once when it starts
+static atomic_ulong context_switch_cost = 0;
+
+void set_context_switch_cost(unsigned long cost)
+{
+    atomic_store_explicit(&context_switch_cost, cost, memory_order_relaxed);
+}
+
+unsigned long get_context_switch_cost(void)
+{
+    return atomic_load_explicit(&context_switch_cost, memory_order_relaxed);
+}
+
+#define SWITCH_NO_JOB UINT32_MAX
+
+typedef struct
+{
+    uint32_t last_job;          // PCB that had the CPU last, SWITCH_NO_JOB before the first dispatch
+    unsigned long cost;         // the context switch cost when the run started
+    unsigned long switches;
+    unsigned long overhead;
+}
+SwitchTracker_t;
+
+// Returns the time it costs to put job on the CPU, free if it was the last one there
+static uint64_t switch_to(SwitchTracker_t *tracker, uint32_t job)
+{
+    uint64_t cost = 0;
+    if (tracker->last_job != SWITCH_NO_JOB && tracker->last_job != job) {
+        cost = tracker->cost;
+        ++tracker->switches;
+        tracker->overhead += cost;
+    }
+    tracker->last_job = job;
+    return cost;
+}
+
 bool first_come_first_serve(dyn_array_t *ready_queue, ScheduleResult_t *result) 
 {
     //If input parameters are incorrect output is false
@@ -31,6 +92,7 @@ bool first_come_first_serve(dyn_array_t *ready_queue, ScheduleResult_t *result)
     unsigned long total_run_time = 0;
 
     // Itterate over the entire size of the queue and proccess in a FIFO order
+    INSTRUMENT_SCOPE(INSTRUMENT_SCHEDULE);
     for(size_t i = 0; i < dyn_array_size(ready_queue); i++){
         ProcessControlBlock_t* pcb = dyn_array_at(ready_queue, i);
 
@@ -54,15 +116,136 @@ bool first_come_first_serve(dyn_array_t *ready_queue, ScheduleResult_t *result)
     result->average_waiting_time = total_waiting_time / dyn_array_size(ready_queue);
     result->average_turnaround_time = total_turnaround_time / dyn_array_size(ready_queue);
     result->total_run_time = total_run_time;
+    result->context_switches = 0;
+    result->switch_overhead = 0;
+
+    return true;
+}
+
+// Descending uint64 keys, so the smallest ends up at the back where it's cheap to take
+static int compare_u64_descending(const void *a, const void *b)
+{
+    return compare_u64(b, a);
+}
+
+// Ready jobs for the shortest/lowest-first schedulers, kept as key << 32 | arrival rank pairs rather than moving
+// the PCBs around. Sorted descending so the next job comes off the back, with room for everyone set aside up front
+typedef struct
+{
+    uint64_t *order;            // arrival order, see build_arrival_order
+    dyn_array_t *ready;
+    dyn_array_t *arrivals;      // the current batch of arrivals, before it's merged into ready
+    size_t next_arrival;
+}
+KeyedQueue_t;
+
+static void keyed_queue_release(KeyedQueue_t *queue)
+{
+    free(queue->order);
+    dyn_array_destroy(queue->ready);
+    dyn_array_destroy(queue->arrivals);
+}
+
+static bool keyed_queue_init(KeyedQueue_t *queue, const PcbTable_t *table)
+{
+    const size_t count = table->count;
+    queue->order = count < UINT32_MAX ? build_arrival_order(table->pcbs, count) : NULL;
+    queue->ready = dyn_array_create(count, sizeof(uint64_t), NULL);
+    queue->arrivals = dyn_array_create(count, sizeof(uint64_t), NULL);
+    queue->next_arrival = 0;
+    if (queue->order == NULL || queue->ready == NULL || queue->arrivals == NULL
+        || dyn_array_capacity(queue->ready) < count || dyn_array_capacity(queue->arrivals) < count) {
+        keyed_queue_release(queue);
+        return false;
+    }
+    return true;
+}
+
+// Admits everything that has arrived by now, keyed on its priority or its remaining burst
+// The batch is sorted on its own and merged in a single pass, rather than binary searched in one at a time with
+// the ready jobs shifted over for each. A big batch (everything arriving at 0, say) is sorted in parallel
+static void keyed_queue_admit(KeyedQueue_t *queue, const CompactPcb_t *pcbs, size_t count, uint64_t now, bool by_burst)
+{
+    for (; queue->next_arrival < count && (queue->order[queue->next_arrival] >> 32) <= now; ++queue->next_arrival) {
+        const CompactPcb_t *pcb = &pcbs[(uint32_t)queue->order[queue->next_arrival]];
+        const uint64_t key = by_burst ? pcb->remaining_burst_time : pcb->priority;
+        const uint64_t entry = (key << 32) | queue->next_arrival;
+        // can't fail, the capacity was checked up front
+        dyn_array_push_back(queue->arrivals, &entry);
+    }
+    if (!dyn_array_empty(queue->arrivals)) {
+        dyn_array_sort_parallel(queue->arrivals, compare_u64_descending, 0);
+        dyn_array_merge_sorted(queue->ready, dyn_array_front(queue->arrivals), dyn_array_size(queue->arrivals),
+                               compare_u64_descending);
+        dyn_array_clear(queue->arrivals);
+    }
+}
+
+// Non-preemptive, lowest key first (priority value or burst) and earliest arrival among equals
+// Like FCFS it charges no context switch cost, see set_context_switch_cost
+// Only the table is touched, whether it's copied back into the ready queue is up to the caller
+static bool run_lowest_first(PcbTable_t *table, bool by_burst, ScheduleResult_t *result)
+{
+    const size_t count = table->count;
+    CompactPcb_t *pcbs = table->pcbs;
+    KeyedQueue_t queue;
+    if (!keyed_queue_init(&queue, table)) {
+        return false;
+    }
+
+    // Variables for time analysis
+    double total_waiting_time = 0;
+    double total_turnaround_time = 0;
+    uint64_t now = 0;
+
+    INSTRUMENT_SCOPE(INSTRUMENT_SCHEDULE);
+    for (size_t completed = 0; completed < count; ++completed) {
+        // Idle CPU, skip ahead to the next arrival
+        if (dyn_array_empty(queue.ready) && (queue.order[queue.next_arrival] >> 32) > now) {
+            now = queue.order[queue.next_arrival] >> 32;
+        }
+        keyed_queue_admit(&queue, pcbs, count, now, by_burst);
+
+        // The job runs its whole burst once it has the CPU
+        uint64_t key;
+        dyn_array_extract_back(queue.ready, &key);
+        const uint32_t job = (uint32_t)queue.order[(uint32_t)key];
+        CompactPcb_t *pcb = &pcbs[job];
+        pcb_table_start(table, job);
+        total_waiting_time += (double)(now - pcb->arrival);
+        now += pcb->remaining_burst_time;
+        pcb->remaining_burst_time = 0;
+        total_turnaround_time += (double)(now - pcb->arrival);
+    }
+
+    // Calculate the average times for the result
+    result->average_waiting_time = (float)(total_waiting_time / count);
+    result->average_turnaround_time = (float)(total_turnaround_time / count);
+    result->total_run_time = (unsigned long)now;
+    result->context_switches = 0;
+    result->switch_overhead = 0;
 
+    keyed_queue_release(&queue);
     return true;
 }
 
-// Comparison function for sorting based on remaining burst time
-int compare_remaining_burst_time(const void *a, const void *b) {
-    ProcessControlBlock_t *pcb_a = *((ProcessControlBlock_t **)a);
-    ProcessControlBlock_t *pcb_b = *((ProcessControlBlock_t **)b);
-    return (pcb_a->remaining_burst_time > pcb_b->remaining_burst_time) - (pcb_a->remaining_burst_time < pcb_b->remaining_burst_time);
+bool priority(dyn_array_t *ready_queue, ScheduleResult_t *result) 
+{
+    // If input parameters are incorrect output is false
+    if (ready_queue == NULL || result == NULL || dyn_array_empty(ready_queue)) {
+        return false;
+    }
+
+    PcbTable_t table;
+    if (!pcb_table_load(&table, ready_queue)) {
+        return false;
+    }
+    const bool success = run_lowest_first(&table, false, result);
+    if (success) {
+        pcb_table_store(&table, ready_queue);
+    }
+    pcb_table_release(&table);
+    return success;
 }
 
 bool shortest_job_first(dyn_array_t *ready_queue, ScheduleResult_t *result) 
@@ -72,127 +255,1089 @@ bool shortest_job_first(dyn_array_t *ready_queue, ScheduleResult_t *result)
         return false;
     }
 
-    // Sort the ready queue based on remaining burst time (SJF)
-    dyn_array_sort(ready_queue, compare_remaining_burst_time);
+    PcbTable_t table;
+    if (!pcb_table_load(&table, ready_queue)) {
+        return false;
+    }
+    const bool success = run_lowest_first(&table, true, result);
+    if (success) {
+        pcb_table_store(&table, ready_queue);
+    }
+    pcb_table_release(&table);
+    return success;
+}
 
-    // Variables for time analysis
-    float total_waiting_time = 0;
-    float total_turnaround_time = 0;
-    unsigned long total_run_time = 0;
+bool shortest_job_first_readonly(const dyn_array_t *ready_queue, ScheduleResult_t *result)
+{
+    if (ready_queue == NULL || result == NULL || dyn_array_empty(ready_queue)) {
+        return false;
+    }
 
-    // Iterate over the entire size of the queue and process in SJF order
-    for (size_t i = 0; i < dyn_array_size(ready_queue); i++) {
-        ProcessControlBlock_t *pcb = dyn_array_at(ready_queue, i);
+    PcbTable_t table;
+    if (!pcb_table_load(&table, ready_queue)) {
+        return false;
+    }
+    const bool success = run_lowest_first(&table, true, result);
+    pcb_table_release(&table);
+    return success;
+}
 
-        // Calculate the waiting time for this process and add it to the total waiting time
-        float waiting_time = total_run_time - pcb->arrival;
-        total_waiting_time += waiting_time;
+bool round_robin(dyn_array_t *ready_queue, ScheduleResult_t *result, size_t quantum) 
+{
+    // If input parameters are incorrect output is false
+    if (ready_queue == NULL || result == NULL || dyn_array_empty(ready_queue) || quantum == 0) {
+        return false;
+    }
 
-        // Calculate this PCB's turnaround time prior to processing the command
-        float turnaround_time = waiting_time + pcb->remaining_burst_time;
+    PcbTable_t table;
+    if (!pcb_table_load(&table, ready_queue)) {
+        return false;
+    }
+    const size_t count = table.count;
+    CompactPcb_t *pcbs = table.pcbs;
+    // Only one slice is ever in flight, so it's just run to its end rather than kept as a timer
+    uint64_t *order = build_arrival_order(pcbs, count);
+    // Each PCB is queued at most once at a time, so a ring of count slots never overflows
+    uint32_t *fifo = malloc(count * sizeof(uint32_t));
+    if (order == NULL || fifo == NULL || count > UINT32_MAX) {
+        free(order);
+        free(fifo);
+        pcb_table_release(&table);
+        return false;
+    }
+    size_t fifo_head = 0;
+    size_t fifo_size = 0;
+    SwitchTracker_t switches = {SWITCH_NO_JOB, get_context_switch_cost(), 0, 0};
 
-        // Perform the execution of the command in the PCB
-        while (pcb->remaining_burst_time > 0) {
-            total_run_time++;
-            virtual_cpu(pcb);
+    // Variables for time analysis
+    double total_waiting_time = 0;
+    double total_turnaround_time = 0;
+    uint64_t now = 0;
+    size_t next_arrival = 0;
+    size_t completed = 0;
+
+    INSTRUMENT_SCOPE(INSTRUMENT_SCHEDULE);
+    while (completed < count) {
+        // CPU idles until the next arrival if nothing is ready
+        if (fifo_size == 0 && (order[next_arrival] >> 32) > now) {
+            now = order[next_arrival] >> 32;
+        }
+        while (next_arrival < count && (order[next_arrival] >> 32) <= now) {
+            fifo[(fifo_head + fifo_size++) % count] = (uint32_t)order[next_arrival++];
         }
 
-        // Update total turnaround
-        total_turnaround_time += turnaround_time;
+        uint32_t job = fifo[fifo_head];
+        fifo_head = (fifo_head + 1) % count;
+        --fifo_size;
+
+        CompactPcb_t *pcb = &pcbs[job];
+        if (pcb_table_start(&table, job)) {
+            total_waiting_time += (double)(now - pcb->arrival);
+        }
+
+        // Run a whole quantum (or what's left of the burst) in one step, after switching to it
+        uint32_t slice = pcb->remaining_burst_time < quantum ? pcb->remaining_burst_time : (uint32_t)quantum;
+        pcb->remaining_burst_time -= slice;
+        now += switch_to(&switches, job) + slice;
+
+        // Anything that arrived during the slice gets in line ahead of the preempted PCB
+        while (next_arrival < count && (order[next_arrival] >> 32) <= now) {
+            fifo[(fifo_head + fifo_size++) % count] = (uint32_t)order[next_arrival++];
+        }
+        if (pcb->remaining_burst_time) {
+            fifo[(fifo_head + fifo_size++) % count] = job;
+        } else {
+            total_turnaround_time += (double)(now - pcb->arrival);
+            ++completed;
+        }
     }
 
     // Calculate the average times for the result
-    result->average_waiting_time = total_waiting_time / dyn_array_size(ready_queue);
-    result->average_turnaround_time = total_turnaround_time / dyn_array_size(ready_queue);
-    result->total_run_time = total_run_time;
+    result->average_waiting_time = (float)(total_waiting_time / count);
+    result->average_turnaround_time = (float)(total_turnaround_time / count);
+    result->total_run_time = (unsigned long)now;
+    result->context_switches = switches.switches;
+    result->switch_overhead = switches.overhead;
 
+    free(fifo);
+    free(order);
+    pcb_table_store(&table, ready_queue);
+    pcb_table_release(&table);
     return true;
 }
 
-bool priority(dyn_array_t *ready_queue, ScheduleResult_t *result) 
+// Opens a file of fixed-size records back to back, leaving it positioned at the first record
+// -1 if the file is missing, empty or not a whole number of records
+static int open_records(const char *input_file, const size_t record_size, size_t *const count)
 {
-    UNUSED(ready_queue);
-    UNUSED(result);
-    return false;   
+    if (input_file == NULL) {
+        return -1;
+    }
+
+    int fd = open(input_file, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    off_t file_size = lseek(fd, 0, SEEK_END);
+    if (file_size <= 0 || (size_t)file_size % record_size != 0 || lseek(fd, 0, SEEK_SET) != 0) {
+        close(fd);
+        return -1;
+    }
+    *count = (size_t)file_size / record_size;
+    return fd;
 }
 
-bool round_robin(dyn_array_t *ready_queue, ScheduleResult_t *result, size_t quantum) 
+// read() can come back short on big files, keep going until we have it all
+static bool read_fully(const int fd, void *const destination, const size_t bytes)
+{
+    size_t bytes_read = 0;
+    while (bytes_read < bytes) {
+        ssize_t chunk = read(fd, (uint8_t *)destination + bytes_read, bytes - bytes_read);
+        if (chunk <= 0) {
+            return false;
+        }
+        bytes_read += (size_t)chunk;
+    }
+    return true;
+}
+
+// Reads a file of fixed-size records back to back into a dyn_array
+// NULL if the file is missing, empty or not a whole number of records
+static dyn_array_t *load_records(const char *input_file, const size_t record_size)
 {
-    UNUSED(ready_queue);
-    UNUSED(result);
-    UNUSED(quantum);
-    return false;
+    size_t count;
+    int fd = open_records(input_file, record_size, &count);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    uint8_t *records = malloc(count * record_size);
+    if (records == NULL || !read_fully(fd, records, count * record_size)) {
+        free(records);
+        close(fd);
+        return NULL;
+    }
+    close(fd);
+
+    // Traces big enough to matter get huge pages, the schedulers sweep them end to end
+    dyn_array_t *array = dyn_array_create_with(count, record_size, NULL, DYN_ALLOC_HUGE_PAGES);
+    if (array != NULL && !dyn_array_append(array, records, count)) {
+        dyn_array_destroy(array);
+        array = NULL;
+    }
+    free(records);
+    return array;
 }
 
 dyn_array_t *load_process_control_blocks(const char *input_file) 
 {
-    UNUSED(input_file);
-    return NULL;
+    INSTRUMENT_SCOPE(INSTRUMENT_LOAD);
+    // The file is nothing but ProcessControlBlock_t records back to back
+    dyn_array_t *ready_queue = load_records(input_file, sizeof(ProcessControlBlock_t));
+    if (ready_queue == NULL) {
+        return NULL;
+    }
+
+    // Nothing has been on a CPU yet, whatever was on disk
+    ProcessControlBlock_t *pcbs = dyn_array_front(ready_queue);
+    for (size_t i = 0; i < dyn_array_size(ready_queue); ++i) {
+        pcbs[i].started = false;
+    }
+    return ready_queue;
+}
+
+bool load_process_control_blocks_into(const char *input_file, dyn_array_t *ready_queue)
+{
+    if (ready_queue == NULL || dyn_array_data_size(ready_queue) != sizeof(ProcessControlBlock_t)) {
+        return false;
+    }
+
+    INSTRUMENT_SCOPE(INSTRUMENT_LOAD);
+    dyn_array_clear(ready_queue);
+    size_t count;
+    int fd = open_records(input_file, sizeof(ProcessControlBlock_t), &count);
+    if (fd < 0) {
+        return false;
+    }
+
+    // A block at a time through the stack, the queue keeps its storage from the last trace so this
+    // only allocates when the trace is bigger than any before it
+    ProcessControlBlock_t block[256];
+    bool success = true;
+    for (size_t loaded = 0; success && loaded < count;) {
+        const size_t block_count = count - loaded < 256 ? count - loaded : 256;
+        success = read_fully(fd, block, block_count * sizeof(ProcessControlBlock_t));
+        for (size_t i = 0; i < block_count; ++i) {
+            block[i].started = false;
+        }
+        success = success && dyn_array_append(ready_queue, block, block_count);
+        loaded += block_count;
+    }
+    close(fd);
+
+    if (!success) {
+        dyn_array_clear(ready_queue);
+    }
+    return success;
+}
+
+dyn_array_t *load_process_deadlines(const char *input_file)
+{
+    INSTRUMENT_SCOPE(INSTRUMENT_LOAD);
+    return load_records(input_file, sizeof(uint32_t));
 }
 
-// Comparison function for sorting by shortest burst time
-int compare_burst_time(const void *a, const void *b) {
-    const ProcessControlBlock_t *pcb_a = *(const ProcessControlBlock_t **)a;
-    const ProcessControlBlock_t *pcb_b = *(const ProcessControlBlock_t **)b;
+// Preemptive, the job with the least work left runs until it finishes or an arrival needs less than it has left
+// Only the table is touched, whether it's copied back into the ready queue is up to the caller
+static bool run_shortest_remaining(PcbTable_t *table, ScheduleResult_t *result)
+{
+    const size_t count = table->count;
+    CompactPcb_t *pcbs = table->pcbs;
+    KeyedQueue_t queue;
+    if (!keyed_queue_init(&queue, table)) {
+        return false;
+    }
+    SwitchTracker_t switches = {SWITCH_NO_JOB, get_context_switch_cost(), 0, 0};
+
+    // Variables for time analysis
+    double total_waiting_time = 0;
+    double total_turnaround_time = 0;
+    uint64_t now = 0;
+    size_t completed = 0;
+    bool running = false;
+    uint64_t current = 0;       // remaining << 32 | arrival rank of the running job, as of now
+
+    INSTRUMENT_SCOPE(INSTRUMENT_SCHEDULE);
+    while (completed < count) {
+        // Idle CPU, skip ahead to the next arrival
+        if (!running && dyn_array_empty(queue.ready) && (queue.order[queue.next_arrival] >> 32) > now) {
+            now = queue.order[queue.next_arrival] >> 32;
+        }
+        keyed_queue_admit(&queue, pcbs, count, now, true);
+
+        // Strictly less work left takes the CPU, a tie leaves it where it is
+        if (running && !dyn_array_empty(queue.ready)
+            && (*(const uint64_t *)dyn_array_back(queue.ready) >> 32) < (current >> 32)) {
+            // can't fail, everyone has room in ready
+            dyn_array_insert_sorted(queue.ready, &current, compare_u64_descending);
+            running = false;
+        }
+        if (!running) {
+            dyn_array_extract_back(queue.ready, &current);
+            running = true;
+            const uint32_t job = (uint32_t)queue.order[(uint32_t)current];
+            if (pcb_table_start(table, job)) {
+                total_waiting_time += (double)(now - pcbs[job].arrival);
+            }
+            // Arrivals during the switch get a look in before the job runs
+            const uint64_t cost = switch_to(&switches, job);
+            if (cost) {
+                now += cost;
+                continue;
+            }
+        }
+
+        // Run until the job finishes or the next arrival, whichever is first
+        CompactPcb_t *pcb = &pcbs[(uint32_t)queue.order[(uint32_t)current]];
+        const uint64_t finish = now + pcb->remaining_burst_time;
+        if (queue.next_arrival < count && (queue.order[queue.next_arrival] >> 32) < finish) {
+            const uint64_t until = queue.order[queue.next_arrival] >> 32;
+            pcb->remaining_burst_time -= (uint32_t)(until - now);
+            now = until;
+            current = ((uint64_t)pcb->remaining_burst_time << 32) | (uint32_t)current;
+            continue;
+        }
+        now = finish;
+        pcb->remaining_burst_time = 0;
+        total_turnaround_time += (double)(now - pcb->arrival);
+        running = false;
+        ++completed;
+    }
+
+    // Calculate the average times for the result
+    result->average_waiting_time = (float)(total_waiting_time / count);
+    result->average_turnaround_time = (float)(total_turnaround_time / count);
+    result->total_run_time = (unsigned long)now;
+    result->context_switches = switches.switches;
+    result->switch_overhead = switches.overhead;
 
-    // Compare burst times
-    return pcb_a->remaining_burst_time - pcb_b->remaining_burst_time;
+    keyed_queue_release(&queue);
+    return true;
 }
 
-// Runs the Shortest Remaining Time First Process Scheduling algorithm over the incoming ready_queue
-// \param ready queue a dyn_array of type ProcessControlBlock_t that contain be up to N elements
-// \param result used for shortest job first stat tracking \ref ScheduleResult_t
-// \return true if function ran successful else false for an error
 bool shortest_remaining_time_first(dyn_array_t *ready_queue, ScheduleResult_t *result) 
 {
-   if(ready_queue == NULL || result == NULL || dyn_array_size(ready_queue) == 0)
-    {
+    if (ready_queue == NULL || result == NULL || dyn_array_empty(ready_queue)) {
         return false;
     }
 
-    // Variables to calculate statistics
-    float waiting_time = 0;
-    float turnaround_time = 0;
-    unsigned long run_time = 0;
-    unsigned long curr_run_time = 0;
+    PcbTable_t table;
+    if (!pcb_table_load(&table, ready_queue)) {
+        return false;
+    }
+    const bool success = run_shortest_remaining(&table, result);
+    if (success) {
+        pcb_table_store(&table, ready_queue);
+    }
+    pcb_table_release(&table);
+    return success;
+}
 
-    dyn_array_sort(ready_queue, compare_remaining_burst_time);
-  
-    // For loop to go through the ready_queue
-    for (size_t i = 0; i < dyn_array_size(ready_queue); ++i) {
-        // Use dyn_array_at the current index to get the current PCB
-        ProcessControlBlock_t *pcb = dyn_array_at(ready_queue, i);
+bool shortest_remaining_time_first_readonly(const dyn_array_t *ready_queue, ScheduleResult_t *result)
+{
+    if (ready_queue == NULL || result == NULL || dyn_array_empty(ready_queue)) {
+        return false;
+    }
+
+    PcbTable_t table;
+    if (!pcb_table_load(&table, ready_queue)) {
+        return false;
+    }
+    const bool success = run_shortest_remaining(&table, result);
+    pcb_table_release(&table);
+    return success;
+}
+
+#define MLFQ_NONE UINT32_MAX
+
+// One FIFO per level, linked through a shared next[] array so boosting is a splice, not a copy
+typedef struct
+{
+    uint32_t head;
+    uint32_t tail;
+}
+MlfqLevel_t;
+
+typedef struct
+{
+    MlfqLevel_t queues[MLFQ_MAX_LEVELS];
+    uint64_t non_empty;     // bit n set iff level n has something queued
+    uint32_t *next;
+}
+MlfqQueues_t;
+
+static void mlfq_push(MlfqQueues_t *mlfq, size_t level, uint32_t job)
+{
+    MlfqLevel_t *queue = &mlfq->queues[level];
+    mlfq->next[job] = MLFQ_NONE;
+    if (queue->head == MLFQ_NONE) {
+        queue->head = job;
+    } else {
+        mlfq->next[queue->tail] = job;
+    }
+    queue->tail = job;
+    mlfq->non_empty |= (uint64_t)1 << level;
+}
+
+static uint32_t mlfq_pop(MlfqQueues_t *mlfq, size_t level)
+{
+    MlfqLevel_t *queue = &mlfq->queues[level];
+    uint32_t job = queue->head;
+    queue->head = mlfq->next[job];
+    if (queue->head == MLFQ_NONE) {
+        queue->tail = MLFQ_NONE;
+        mlfq->non_empty &= ~((uint64_t)1 << level);
+    }
+    return job;
+}
+
+// Priority boost: append every lower level onto level 0, keeping level order, O(levels)
+static void mlfq_boost(MlfqQueues_t *mlfq, size_t levels)
+{
+    MlfqLevel_t *top = &mlfq->queues[0];
+    for (size_t level = 1; level < levels; ++level) {
+        MlfqLevel_t *queue = &mlfq->queues[level];
+        if (queue->head == MLFQ_NONE) {
+            continue;
+        }
+        if (top->head == MLFQ_NONE) {
+            top->head = queue->head;
+        } else {
+            mlfq->next[top->tail] = queue->head;
+        }
+        top->tail = queue->tail;
+        queue->head = queue->tail = MLFQ_NONE;
+    }
+    mlfq->non_empty = top->head == MLFQ_NONE ? 0 : 1;
+}
 
-        // Make sure that the PCB is not null
-        if (pcb == NULL) {
-            return false; // PCB is null, therefore unsuccessful
+bool multilevel_feedback_queue(dyn_array_t *ready_queue, ScheduleResult_t *result, const MlfqConfig_t *config)
+{
+    if (ready_queue == NULL || result == NULL || config == NULL || dyn_array_empty(ready_queue)) {
+        return false;
+    }
+    if (config->levels == 0 || config->levels > MLFQ_MAX_LEVELS || dyn_array_size(ready_queue) >= MLFQ_NONE) {
+        return false;
+    }
+    for (size_t level = 0; level < config->levels; ++level) {
+        if (config->quanta[level] == 0) {
+            return false;
         }
+    }
+
+    PcbTable_t table;
+    if (!pcb_table_load(&table, ready_queue)) {
+        return false;
+    }
+    const size_t count = table.count;
+    CompactPcb_t *pcbs = table.pcbs;
 
-        // Calculate waiting time for the current process
-        waiting_time += run_time;
+    MlfqQueues_t mlfq;
+    for (size_t level = 0; level < MLFQ_MAX_LEVELS; ++level) {
+        mlfq.queues[level].head = mlfq.queues[level].tail = MLFQ_NONE;
+    }
+    mlfq.non_empty = 0;
+    mlfq.next = malloc(count * sizeof(uint32_t));
+    uint64_t *order = build_arrival_order(pcbs, count);
+    if (mlfq.next == NULL || order == NULL) {
+        free(mlfq.next);
+        free(order);
+        pcb_table_release(&table);
+        return false;
+    }
 
-        // Simulate processing on virtual CPU until the process is executed
-        while (pcb->remaining_burst_time > 0) {
-            virtual_cpu(pcb);
-            ++curr_run_time;
+    // Variables for time analysis
+    double total_waiting_time = 0;
+    double total_turnaround_time = 0;
+    uint64_t now = 0;
+    size_t completed = 0;
+    size_t next_arrival = 0;
+
+    uint32_t running = MLFQ_NONE;
+    size_t running_level = 0;
+    uint64_t slice_start = 0;
+    uint64_t slice_end = 0;
+    uint64_t next_boost = config->boost_interval ? config->boost_interval : UINT64_MAX;
+    SwitchTracker_t switches = {SWITCH_NO_JOB, get_context_switch_cost(), 0, 0};
+
+    INSTRUMENT_SCOPE(INSTRUMENT_SCHEDULE);
+    while (completed < count) {
+        // Jump to the next slice end, arrival, or boost (boosts only matter if something sits below level 0)
+        uint64_t next = UINT64_MAX;
+        if (running != MLFQ_NONE) {
+            next = slice_end;
+        }
+        if (next_arrival < count && (order[next_arrival] >> 32) < next) {
+            next = order[next_arrival] >> 32;
+        }
+        if ((mlfq.non_empty > 1 || (running != MLFQ_NONE && running_level)) && next_boost < next) {
+            next = next_boost;
+        }
+        if (next > now) {
+            now = next;
+        }
+
+        // Arrivals enter at the top, the slice end (if it's now) is handled after them
+        while (next_arrival < count && (order[next_arrival] >> 32) <= now) {
+            mlfq_push(&mlfq, 0, (uint32_t)order[next_arrival++]);
+        }
+        const bool slice_ended = running != MLFQ_NONE && slice_end == now;
+
+        // Slice ended: finished, or used the whole quantum and drops a level
+        // Either way it goes in behind whatever just arrived
+        if (slice_ended) {
+            CompactPcb_t *pcb = &pcbs[running];
+            pcb->remaining_burst_time -= (uint32_t)(now - slice_start);
+            if (pcb->remaining_burst_time == 0) {
+                total_turnaround_time += (double)(now - pcb->arrival);
+                ++completed;
+            } else {
+                mlfq_push(&mlfq, running_level + 1 < config->levels ? running_level + 1 : running_level, running);
+            }
+            running = MLFQ_NONE;
+        }
+
+        if (now >= next_boost) {
+            mlfq_boost(&mlfq, config->levels);
+            running_level = 0;
+            next_boost = (now / config->boost_interval + 1) * config->boost_interval;
+        }
+
+        // Something queued above the running PCB's level takes the CPU, the loser keeps its level
+        if (running != MLFQ_NONE && mlfq.non_empty
+            && (size_t)__builtin_ctzll(mlfq.non_empty) < running_level) {
+            // it may not even have finished switching in yet
+            pcbs[running].remaining_burst_time -= (uint32_t)(now > slice_start ? now - slice_start : 0);
+            mlfq_push(&mlfq, running_level, running);
+            running = MLFQ_NONE;
+        }
+
+        if (running == MLFQ_NONE && mlfq.non_empty) {
+            running_level = (size_t)__builtin_ctzll(mlfq.non_empty);
+            running = mlfq_pop(&mlfq, running_level);
+
+            CompactPcb_t *pcb = &pcbs[running];
+            if (pcb_table_start(&table, running)) {
+                total_waiting_time += (double)(now - pcb->arrival);
+            }
+            uint64_t slice = pcb->remaining_burst_time;
+            if (slice > config->quanta[running_level]) {
+                slice = config->quanta[running_level];
+            }
+            slice_start = now + switch_to(&switches, running);
+            slice_end = slice_start + slice;
+        }
+    }
+
+    // calculate the average times for the result
+    result->average_waiting_time = (float)(total_waiting_time / count);
+    result->average_turnaround_time = (float)(total_turnaround_time / count);
+    result->total_run_time = (unsigned long)now;
+    result->context_switches = switches.switches;
+    result->switch_overhead = switches.overhead;
+
+    free(order);
+    free(mlfq.next);
+    pcb_table_store(&table, ready_queue);
+    pcb_table_release(&table);
+    return true;
+}
+
+// Weight of each nice level from -20 to 19, same table the Linux CFS uses (nice 0 = 1024)
+// Each step is roughly 10% more or less CPU
+static const uint32_t cfs_prio_to_weight[40] = {
+    88761, 71755, 56483, 46273, 36291,
+    29154, 23254, 18705, 14949, 11916,
+    9548,  7620,  6100,  4904,  3906,
+    3121,  2501,  1991,  1586,  1277,
+    1024,  820,   655,   526,   423,
+    335,   272,   215,   172,   137,
+    110,   87,    70,    56,    45,
+    36,    29,    23,    18,    15,
+};
+
+// vruntime is kept in fixed point so heavy weights still see single ticks
+#define CFS_VRUNTIME_SHIFT 20
+
+typedef struct
+{
+    rb_node_t node;         // linked into the timeline while runnable and off the CPU
+    uint64_t vruntime;      // weighted virtual runtime, fixed point
+    uint32_t job;           // index of the PCB in the ready queue
+    uint32_t weight;
+}
+CfsEntity_t;
+
+static int compare_vruntime(const rb_node_t *const a, const rb_node_t *const b)
+{
+    const uint64_t vruntime_a = RB_ENTRY(a, CfsEntity_t, node)->vruntime;
+    const uint64_t vruntime_b = RB_ENTRY(b, CfsEntity_t, node)->vruntime;
+    return (vruntime_a > vruntime_b) - (vruntime_a < vruntime_b);
+}
+
+bool completely_fair_scheduler(dyn_array_t *ready_queue, ScheduleResult_t *result, size_t target_latency)
+{
+    // If input parameters are incorrect output is false
+    if (ready_queue == NULL || result == NULL || dyn_array_empty(ready_queue) || target_latency == 0) {
+        return false;
+    }
+
+    PcbTable_t table;
+    if (!pcb_table_load(&table, ready_queue)) {
+        return false;
+    }
+    const size_t count = table.count;
+    CompactPcb_t *pcbs = table.pcbs;
+    uint64_t *order = build_arrival_order(pcbs, count);
+    CfsEntity_t *entities = malloc(count * sizeof(CfsEntity_t));
+    if (order == NULL || entities == NULL) {
+        free(order);
+        free(entities);
+        pcb_table_release(&table);
+        return false;
+    }
+
+    rb_tree_t timeline;
+    rb_tree_init(&timeline, compare_vruntime);
+
+    // Variables for time analysis
+    double total_waiting_time = 0;
+    double total_turnaround_time = 0;
+    uint64_t now = 0;
+    uint64_t min_vruntime = 0;
+    uint64_t total_weight = 0;   // weight of everything runnable, including whatever is on the CPU
+    size_t next_arrival = 0;
+    size_t completed = 0;
+    SwitchTracker_t switches = {SWITCH_NO_JOB, get_context_switch_cost(), 0, 0};
+
+    INSTRUMENT_SCOPE(INSTRUMENT_SCHEDULE);
+    while (completed < count) {
+        if (rb_tree_size(&timeline) == 0 && (order[next_arrival] >> 32) > now) {
+            now = order[next_arrival] >> 32;
+        }
+        // Newcomers start at the queue's min_vruntime so they can't starve everybody else
+        while (next_arrival < count && (order[next_arrival] >> 32) <= now) {
+            uint32_t job = (uint32_t)order[next_arrival++];
+            uint32_t nice_index = pcbs[job].priority < 40 ? pcbs[job].priority : 39;
+            entities[job].job = job;
+            entities[job].weight = cfs_prio_to_weight[nice_index];
+            entities[job].vruntime = min_vruntime;
+            total_weight += entities[job].weight;
+            rb_tree_insert(&timeline, &entities[job].node);
+        }
+
+        // Pick next is the leftmost (smallest vruntime) entity, O(1) from the cached pointer
+        CfsEntity_t *current = RB_ENTRY(rb_tree_first(&timeline), CfsEntity_t, node);
+        rb_tree_erase(&timeline, &current->node);
+        CompactPcb_t *pcb = &pcbs[current->job];
+        if (pcb_table_start(&table, current->job)) {
+            total_waiting_time += (double)(now - pcb->arrival);
+        }
+
+        // Each runnable PCB gets its weighted share of the target latency, at least one tick
+        uint64_t slice = (uint64_t)target_latency * current->weight / total_weight;
+        if (slice == 0) {
+            slice = 1;
+        }
+        if (slice > pcb->remaining_burst_time) {
+            slice = pcb->remaining_burst_time;
+        }
+        pcb->remaining_burst_time -= (uint32_t)slice;
+        now += switch_to(&switches, current->job) + slice;
+        current->vruntime += (slice << CFS_VRUNTIME_SHIFT) / current->weight;
+
+        // min_vruntime only moves forward, tracking the smallest vruntime still runnable
+        uint64_t smallest = current->vruntime;
+        if (rb_tree_size(&timeline)) {
+            uint64_t leftmost = RB_ENTRY(rb_tree_first(&timeline), CfsEntity_t, node)->vruntime;
+            if (leftmost < smallest || pcb->remaining_burst_time == 0) {
+                smallest = leftmost;
+            }
+        }
+        if (smallest > min_vruntime) {
+            min_vruntime = smallest;
+        }
+
+        if (pcb->remaining_burst_time) {
+            rb_tree_insert(&timeline, &current->node);
+        } else {
+            total_weight -= current->weight;
+            total_turnaround_time += (double)(now - pcb->arrival);
+            ++completed;
+        }
+    }
+
+    // Calculate the average times for the result
+    result->average_waiting_time = (float)(total_waiting_time / count);
+    result->average_turnaround_time = (float)(total_turnaround_time / count);
+    result->total_run_time = (unsigned long)now;
+    result->context_switches = switches.switches;
+    result->switch_overhead = switches.overhead;
+
+    free(entities);
+    free(order);
+    pcb_table_store(&table, ready_queue);
+    pcb_table_release(&table);
+    return true;
+}
+
+bool earliest_deadline_first(dyn_array_t *ready_queue, const dyn_array_t *deadlines, DeadlineResult_t *result)
+{
+    // If input parameters are incorrect output is false
+    if (ready_queue == NULL || result == NULL || dyn_array_empty(ready_queue)) {
+        return false;
+    }
+    const size_t count = dyn_array_size(ready_queue);
+    if (deadlines != NULL
+        && (dyn_array_size(deadlines) != count || dyn_array_data_size(deadlines) != sizeof(uint32_t))) {
+        return false;
+    }
+
+    PcbTable_t table;
+    if (!pcb_table_load(&table, ready_queue)) {
+        return false;
+    }
+    CompactPcb_t *pcbs = table.pcbs;
+    const uint32_t *deadline_of = deadlines ? dyn_array_front(deadlines) : NULL;
+    uint64_t *order = build_arrival_order(pcbs, count);
+    // Tardiness of every PCB that has a deadline, sorted at the end for the percentiles
+    uint64_t *tardiness = malloc(count * sizeof(uint64_t));
+    priority_queue_t *ready = priority_queue_create(count);
+    if (order == NULL || tardiness == NULL || ready == NULL) {
+        free(order);
+        free(tardiness);
+        priority_queue_destroy(ready);
+        pcb_table_release(&table);
+        return false;
+    }
+
+    // Variables for time analysis
+    double total_waiting_time = 0;
+    double total_turnaround_time = 0;
+    double total_lateness = 0;
+    size_t deadline_count = 0;
+    size_t deadline_misses = 0;
+    uint64_t now = 0;
+    size_t next_arrival = 0;
+    size_t completed = 0;
+    bool running = false;
+    pq_entry_t current = {0, 0, 0};     // key is the running PCB's deadline, value its index
+    SwitchTracker_t switches = {SWITCH_NO_JOB, get_context_switch_cost(), 0, 0};
+
+    INSTRUMENT_SCOPE(INSTRUMENT_SCHEDULE);
+    while (completed < count) {
+        if (!running && priority_queue_empty(ready) && (order[next_arrival] >> 32) > now) {
+            now = order[next_arrival] >> 32;
+        }
+        while (next_arrival < count && (order[next_arrival] >> 32) <= now) {
+            uint32_t job = (uint32_t)order[next_arrival++];
+            uint64_t deadline = deadline_of ? deadline_of[job] : EDF_NO_DEADLINE;
+            if (!priority_queue_push(ready, deadline, job)) {
+                free(order);
+                free(tardiness);
+                priority_queue_destroy(ready);
+                pcb_table_release(&table);
+                return false;
+            }
+        }
+
+        // Only an arrival can bring in an earlier deadline, so this is the only place to preempt
+        if (running && !priority_queue_empty(ready) && priority_queue_top(ready)->key < current.key) {
+            // can't fail, the heap was sized for every PCB up front
+            priority_queue_push(ready, current.key, current.value);
+            running = false;
+        }
+        if (!running) {
+            priority_queue_pop(ready, &current);
+            running = true;
+
+            CompactPcb_t *pcb = &pcbs[current.value];
+            if (pcb_table_start(&table, current.value)) {
+                total_waiting_time += (double)(now - pcb->arrival);
+            }
+            // Anything that arrives while switching in gets its chance to preempt before the PCB runs
+            uint64_t cost = switch_to(&switches, (uint32_t)current.value);
+            if (cost) {
+                now += cost;
+                continue;
+            }
+        }
+
+        CompactPcb_t *pcb = &pcbs[current.value];
+
+        // Run until the PCB finishes or the next arrival, whichever is first
+        uint64_t finish = now + pcb->remaining_burst_time;
+        if (next_arrival < count && (order[next_arrival] >> 32) < finish) {
+            uint64_t until = order[next_arrival] >> 32;
+            pcb->remaining_burst_time -= (uint32_t)(until - now);
+            now = until;
+            continue;
+        }
+
+        pcb->remaining_burst_time = 0;
+        now = finish;
+        running = false;
+        ++completed;
+        total_turnaround_time += (double)(now - pcb->arrival);
+        if (current.key != EDF_NO_DEADLINE) {
+            uint64_t late = now > current.key ? now - current.key : 0;
+            tardiness[deadline_count++] = late;
+            if (late) {
+                ++deadline_misses;
+                total_lateness += (double)late;
+            }
+        }
+    }
+
+    memset(result, 0, sizeof(DeadlineResult_t));
+    result->schedule.average_waiting_time = (float)(total_waiting_time / count);
+    result->schedule.average_turnaround_time = (float)(total_turnaround_time / count);
+    result->schedule.total_run_time = (unsigned long)now;
+    result->schedule.context_switches = switches.switches;
+    result->schedule.switch_overhead = switches.overhead;
+    result->deadline_count = deadline_count;
+    result->deadline_misses = deadline_misses;
+    result->total_lateness = total_lateness;
+    if (deadline_count) {
+        qsort(tardiness, deadline_count, sizeof(uint64_t), compare_u64);
+        result->tardiness_p50 = percentile(tardiness, deadline_count, 50);
+        result->tardiness_p95 = percentile(tardiness, deadline_count, 95);
+        result->tardiness_p99 = percentile(tardiness, deadline_count, 99);
+        result->tardiness_max = (unsigned long)tardiness[deadline_count - 1];
+    }
+
+    free(order);
+    free(tardiness);
+    priority_queue_destroy(ready);
+    pcb_table_store(&table, ready_queue);
+    pcb_table_release(&table);
+    return true;
+}
+
+// Per-PCB bookkeeping for the proportional-share schedulers
+typedef struct
+{
+    double entry_clock;     // share clock when the PCB became runnable
+    uint64_t tickets;       // share weight
+    uint32_t burst;         // service the PCB will end up receiving
+}
+ShareJob_t;
+
+// Running comparison of what each PCB got against what an ideal fluid proportional-share CPU would have given it
+// The share clock advances by slice / total_tickets, so a PCB's fair service over its life is
+// tickets * (clock at exit - clock at entry), tracked in O(1) per slice whatever the runnable set size
+typedef struct
+{
+    double clock;
+    uint64_t total_tickets;
+    double *ratios;         // achieved over target of each retired PCB, sorted at the end for the median
+    size_t rated;           // PCBs in ratios, the ones that had service to get
+    size_t retired;
+    double lag_sum;
+}
+ShareTracker_t;
+
+// Priority is the share weight, a priority of 0 still gets one ticket so it can finish
+static uint64_t share_tickets(const CompactPcb_t *pcb)
+{
+    return pcb->priority ? pcb->priority : 1;
+}
+
+static void share_admit(ShareTracker_t *tracker, ShareJob_t *job, const CompactPcb_t *pcb)
+{
+    job->entry_clock = tracker->clock;
+    job->tickets = share_tickets(pcb);
+    job->burst = pcb->remaining_burst_time;
+    tracker->total_tickets += job->tickets;
+}
+
+static void share_retire(ShareTracker_t *tracker, const ShareJob_t *job)
+{
+    double target = (double)job->tickets * (tracker->clock - job->entry_clock);
+    double lag = job->burst - target;
+    // A zero burst retires the moment it's dispatched with nothing due either way, 0 / 0 has no place in the ratios
+    if (job->burst && target > 0) {
+        tracker->ratios[tracker->rated++] = job->burst / target;
+    }
+    ++tracker->retired;
+    tracker->lag_sum += lag < 0 ? -lag : lag;
+    tracker->total_tickets -= job->tickets;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    const double value_a = *(const double *)a;
+    const double value_b = *(const double *)b;
+    return (value_a > value_b) - (value_a < value_b);
+}
+
+static void share_fill_result(const ShareTracker_t *tracker, ShareResult_t *result)
+{
+    // Short PCBs that finish inside one quantum get huge ratios, the median isn't thrown by them like a mean is
+    // Nothing rated means every PCB had a zero burst, none of them was treated unfairly
+    qsort(tracker->ratios, tracker->rated, sizeof(double), compare_double);
+    result->median_share_ratio = tracker->rated ? tracker->ratios[tracker->rated / 2] : 1.0;
+    result->min_share_ratio = tracker->rated ? tracker->ratios[0] : 1.0;
+    result->max_share_ratio = tracker->rated ? tracker->ratios[tracker->rated - 1] : 1.0;
+    result->mean_absolute_lag = tracker->lag_sum / tracker->retired;
+}
+
+// pass advances in the same fixed point as CFS vruntime, a ticket-weighted slice per dispatch
+#define STRIDE_PASS_SHIFT 20
+
+bool stride_scheduling(dyn_array_t *ready_queue, ShareResult_t *result, size_t quantum)
+{
+    // If input parameters are incorrect output is false
+    if (ready_queue == NULL || result == NULL || dyn_array_empty(ready_queue) || quantum == 0) {
+        return false;
+    }
+
+    PcbTable_t table;
+    if (!pcb_table_load(&table, ready_queue)) {
+        return false;
+    }
+    const size_t count = table.count;
+    CompactPcb_t *pcbs = table.pcbs;
+    uint64_t *order = build_arrival_order(pcbs, count);
+    ShareJob_t *jobs = malloc(count * sizeof(ShareJob_t));
+    // keyed on pass, equal passes take turns in FIFO order
+    priority_queue_t *ready = priority_queue_create(count);
+    ShareTracker_t tracker = {0, 0, malloc(count * sizeof(double)), 0, 0, 0};
+    if (order == NULL || jobs == NULL || ready == NULL || tracker.ratios == NULL) {
+        free(order);
+        free(jobs);
+        priority_queue_destroy(ready);
+        free(tracker.ratios);
+        pcb_table_release(&table);
+        return false;
+    }
+
+    // Variables for time analysis
+    double total_waiting_time = 0;
+    double total_turnaround_time = 0;
+    uint64_t now = 0;
+    uint64_t global_pass = 0;   // pass of the last PCB dispatched, the smallest runnable pass
+    SwitchTracker_t switches = {SWITCH_NO_JOB, get_context_switch_cost(), 0, 0};
+    size_t next_arrival = 0;
+    size_t completed = 0;
+
+    INSTRUMENT_SCOPE(INSTRUMENT_SCHEDULE);
+    while (completed < count) {
+        if (priority_queue_empty(ready) && (order[next_arrival] >> 32) > now) {
+            now = order[next_arrival] >> 32;
+        }
+        // Newcomers join at the current global pass, so they neither starve others nor get starved
+        // The heap was sized for every PCB up front, pushes can't fail
+        while (next_arrival < count && (order[next_arrival] >> 32) <= now) {
+            uint32_t job = (uint32_t)order[next_arrival++];
+            share_admit(&tracker, &jobs[job], &pcbs[job]);
+            priority_queue_push(ready, global_pass, job);
+        }
+
+        pq_entry_t current;
+        priority_queue_pop(ready, &current);
+        global_pass = current.key;
+        CompactPcb_t *pcb = &pcbs[current.value];
+        if (pcb_table_start(&table, current.value)) {
+            total_waiting_time += (double)(now - pcb->arrival);
+        }
+
+        uint32_t slice = pcb->remaining_burst_time < quantum ? pcb->remaining_burst_time : (uint32_t)quantum;
+        pcb->remaining_burst_time -= slice;
+        now += switch_to(&switches, (uint32_t)current.value) + slice;
+        tracker.clock += (double)slice / (double)tracker.total_tickets;
+
+        if (pcb->remaining_burst_time) {
+            uint64_t pass = current.key + ((uint64_t)slice << STRIDE_PASS_SHIFT) / jobs[current.value].tickets;
+            priority_queue_push(ready, pass, current.value);
+        } else {
+            share_retire(&tracker, &jobs[current.value]);
+            total_turnaround_time += (double)(now - pcb->arrival);
+            ++completed;
+        }
+    }
+
+    memset(result, 0, sizeof(ShareResult_t));
+    result->schedule.average_waiting_time = (float)(total_waiting_time / count);
+    result->schedule.average_turnaround_time = (float)(total_turnaround_time / count);
+    result->schedule.total_run_time = (unsigned long)now;
+    result->schedule.context_switches = switches.switches;
+    result->schedule.switch_overhead = switches.overhead;
+    share_fill_result(&tracker, result);
+
+    free(order);
+    free(jobs);
+    priority_queue_destroy(ready);
+    free(tracker.ratios);
+    pcb_table_store(&table, ready_queue);
+    pcb_table_release(&table);
+    return true;
+}
+
+// Fenwick (binary indexed) tree over ticket counts, 1-based, so a weighted draw is O(log n)
+static void fenwick_add(uint64_t *tree, size_t size, size_t index, uint64_t delta)
+{
+    for (size_t i = index + 1; i <= size; i += i & (~i + 1)) {
+        tree[i] += delta;
+    }
+}
+
+// Index of the PCB holding winning ticket number draw (0 <= draw < total tickets)
+static size_t fenwick_find(const uint64_t *tree, size_t size, uint64_t draw)
+{
+    size_t position = 0;
+    size_t step = 1;
+    while (step <= size / 2) {
+        step <<= 1;
+    }
+    for (; step; step >>= 1) {
+        if (position + step <= size && tree[position + step] <= draw) {
+            position += step;
+            draw -= tree[position];
         }
+    }
+    return position;
+}
 
-        // Calculate turnaround time for the current process
-        turnaround_time += curr_run_time;
+// xorshift64*, fast and plenty random for drawing tickets
+static uint64_t lottery_random(uint64_t *state)
+{
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
 
-        run_time += curr_run_time;
+bool lottery_scheduling(dyn_array_t *ready_queue, ShareResult_t *result, size_t quantum, uint64_t seed)
+{
+    // If input parameters are incorrect output is false
+    if (ready_queue == NULL || result == NULL || dyn_array_empty(ready_queue) || quantum == 0) {
+        return false;
+    }
 
-        curr_run_time = 0;
+    PcbTable_t table;
+    if (!pcb_table_load(&table, ready_queue)) {
+        return false;
+    }
+    const size_t count = table.count;
+    CompactPcb_t *pcbs = table.pcbs;
+    uint64_t *order = build_arrival_order(pcbs, count);
+    ShareJob_t *jobs = malloc(count * sizeof(ShareJob_t));
+    uint64_t *tickets = calloc(count + 1, sizeof(uint64_t));
+    ShareTracker_t tracker = {0, 0, malloc(count * sizeof(double)), 0, 0, 0};
+    if (order == NULL || jobs == NULL || tickets == NULL || tracker.ratios == NULL) {
+        free(order);
+        free(jobs);
+        free(tickets);
+        free(tracker.ratios);
+        pcb_table_release(&table);
+        return false;
     }
-    
-    // Set the average waiting time
-    result->average_waiting_time = waiting_time / dyn_array_size(ready_queue);
 
-    // Set the average turnaround time
-    result->average_turnaround_time = turnaround_time / dyn_array_size(ready_queue);
+    uint64_t rng_state = seed ? seed : 0x9E3779B97F4A7C15ULL;
+    SwitchTracker_t switches = {SWITCH_NO_JOB, get_context_switch_cost(), 0, 0};
+    // Variables for time analysis
+    double total_waiting_time = 0;
+    double total_turnaround_time = 0;
+    uint64_t now = 0;
+    size_t next_arrival = 0;
+    size_t completed = 0;
+
+    INSTRUMENT_SCOPE(INSTRUMENT_SCHEDULE);
+    while (completed < count) {
+        if (tracker.total_tickets == 0 && (order[next_arrival] >> 32) > now) {
+            now = order[next_arrival] >> 32;
+        }
+        while (next_arrival < count && (order[next_arrival] >> 32) <= now) {
+            uint32_t job = (uint32_t)order[next_arrival++];
+            share_admit(&tracker, &jobs[job], &pcbs[job]);
+            fenwick_add(tickets, count, job, jobs[job].tickets);
+        }
+
+        size_t winner = fenwick_find(tickets, count, lottery_random(&rng_state) % tracker.total_tickets);
+        CompactPcb_t *pcb = &pcbs[winner];
+        if (pcb_table_start(&table, winner)) {
+            total_waiting_time += (double)(now - pcb->arrival);
+        }
+
+        uint32_t slice = pcb->remaining_burst_time < quantum ? pcb->remaining_burst_time : (uint32_t)quantum;
+        pcb->remaining_burst_time -= slice;
+        now += switch_to(&switches, (uint32_t)winner) + slice;
+        tracker.clock += (double)slice / (double)tracker.total_tickets;
+
+        if (pcb->remaining_burst_time == 0) {
+            // adding the two's complement takes the tickets back out of the tree
+            fenwick_add(tickets, count, winner, ~jobs[winner].tickets + 1);
+            share_retire(&tracker, &jobs[winner]);
+            total_turnaround_time += (double)(now - pcb->arrival);
+            ++completed;
+        }
+    }
 
-    // Set the total run time
-    result->total_run_time = run_time;
+    memset(result, 0, sizeof(ShareResult_t));
+    result->schedule.average_waiting_time = (float)(total_waiting_time / count);
+    result->schedule.average_turnaround_time = (float)(total_turnaround_time / count);
+    result->schedule.total_run_time = (unsigned long)now;
+    result->schedule.context_switches = switches.switches;
+    result->schedule.switch_overhead = switches.overhead;
+    share_fill_result(&tracker, result);
 
-    return true;   
+    free(order);
+    free(jobs);
+    free(tickets);
+    free(tracker.ratios);
+    pcb_table_store(&table, ready_queue);
+    pcb_table_release(&table);
+    return true;
 }
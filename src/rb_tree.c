@@ -0,0 +1,365 @@
+#include "rb_tree.h"
+
+// Standard red-black tree (CLRS), with NULL standing in for the black leaves
+// Since the leaves aren't real nodes, erase has to track the fixup node's parent separately
+
+static void rb_rotate_left(rb_tree_t *const tree, rb_node_t *const node)
+{
+    rb_node_t *pivot = node->right;
+    node->right = pivot->left;
+    if (pivot->left)
+    {
+        pivot->left->parent = node;
+    }
+    pivot->parent = node->parent;
+    if (!node->parent)
+    {
+        tree->root = pivot;
+    }
+    else if (node == node->parent->left)
+    {
+        node->parent->left = pivot;
+    }
+    else
+    {
+        node->parent->right = pivot;
+    }
+    pivot->left = node;
+    node->parent = pivot;
+}
+
+static void rb_rotate_right(rb_tree_t *const tree, rb_node_t *const node)
+{
+    rb_node_t *pivot = node->left;
+    node->left = pivot->right;
+    if (pivot->right)
+    {
+        pivot->right->parent = node;
+    }
+    pivot->parent = node->parent;
+    if (!node->parent)
+    {
+        tree->root = pivot;
+    }
+    else if (node == node->parent->right)
+    {
+        node->parent->right = pivot;
+    }
+    else
+    {
+        node->parent->left = pivot;
+    }
+    pivot->right = node;
+    node->parent = pivot;
+}
+
+static inline bool rb_is_red(const rb_node_t *const node)
+{
+    return node && node->red;
+}
+
+// Puts replacement where node was in node's parent (replacement may be NULL)
+static void rb_transplant(rb_tree_t *const tree, rb_node_t *const node, rb_node_t *const replacement)
+{
+    if (!node->parent)
+    {
+        tree->root = replacement;
+    }
+    else if (node == node->parent->left)
+    {
+        node->parent->left = replacement;
+    }
+    else
+    {
+        node->parent->right = replacement;
+    }
+    if (replacement)
+    {
+        replacement->parent = node->parent;
+    }
+}
+
+static rb_node_t *rb_minimum(rb_node_t *node)
+{
+    while (node->left)
+    {
+        node = node->left;
+    }
+    return node;
+}
+
+void rb_tree_init(rb_tree_t *const tree, int (*const compare)(const rb_node_t *const, const rb_node_t *const))
+{
+    if (tree)
+    {
+        tree->root = NULL;
+        tree->leftmost = NULL;
+        tree->size = 0;
+        tree->compare = compare;
+    }
+}
+
+bool rb_tree_insert(rb_tree_t *const tree, rb_node_t *const node)
+{
+    if (!tree || !node || !tree->compare)
+    {
+        return false;
+    }
+
+    rb_node_t *parent = NULL;
+    rb_node_t *walker = tree->root;
+    bool leftmost = true;
+    bool go_left = false;
+    while (walker)
+    {
+        parent = walker;
+        go_left = tree->compare(node, walker) < 0;
+        if (go_left)
+        {
+            walker = walker->left;
+        }
+        else
+        {
+            walker = walker->right;
+            leftmost = false;
+        }
+    }
+
+    node->parent = parent;
+    node->left = node->right = NULL;
+    node->red = true;
+    if (!parent)
+    {
+        tree->root = node;
+    }
+    else if (go_left)
+    {
+        parent->left = node;
+    }
+    else
+    {
+        parent->right = node;
+    }
+    if (leftmost)
+    {
+        tree->leftmost = node;
+    }
+    ++tree->size;
+
+    // Fix any red-red violation walking up
+    rb_node_t *current = node;
+    while (rb_is_red(current->parent))
+    {
+        parent = current->parent;
+        rb_node_t *grandparent = parent->parent;  // exists, a red node is never the root
+        if (parent == grandparent->left)
+        {
+            rb_node_t *uncle = grandparent->right;
+            if (rb_is_red(uncle))
+            {
+                parent->red = false;
+                uncle->red = false;
+                grandparent->red = true;
+                current = grandparent;
+                continue;
+            }
+            if (current == parent->right)
+            {
+                rb_rotate_left(tree, parent);
+                current = parent;
+                parent = current->parent;
+            }
+            parent->red = false;
+            grandparent->red = true;
+            rb_rotate_right(tree, grandparent);
+        }
+        else
+        {
+            rb_node_t *uncle = grandparent->left;
+            if (rb_is_red(uncle))
+            {
+                parent->red = false;
+                uncle->red = false;
+                grandparent->red = true;
+                current = grandparent;
+                continue;
+            }
+            if (current == parent->left)
+            {
+                rb_rotate_right(tree, parent);
+                current = parent;
+                parent = current->parent;
+            }
+            parent->red = false;
+            grandparent->red = true;
+            rb_rotate_left(tree, grandparent);
+        }
+    }
+    tree->root->red = false;
+    return true;
+}
+
+bool rb_tree_erase(rb_tree_t *const tree, rb_node_t *const node)
+{
+    if (!tree || !node || !tree->size)
+    {
+        return false;
+    }
+
+    if (tree->leftmost == node)
+    {
+        tree->leftmost = rb_tree_next(node);
+    }
+
+    // fixup_node takes the removed node's place, it may be a NULL leaf so keep its parent on the side
+    rb_node_t *fixup_node;
+    rb_node_t *fixup_parent;
+    bool removed_red = node->red;
+
+    if (!node->left)
+    {
+        fixup_node = node->right;
+        fixup_parent = node->parent;
+        rb_transplant(tree, node, node->right);
+    }
+    else if (!node->right)
+    {
+        fixup_node = node->left;
+        fixup_parent = node->parent;
+        rb_transplant(tree, node, node->left);
+    }
+    else
+    {
+        // two children, the successor moves up into node's spot
+        rb_node_t *successor = rb_minimum(node->right);
+        removed_red = successor->red;
+        fixup_node = successor->right;
+        if (successor->parent == node)
+        {
+            fixup_parent = successor;
+        }
+        else
+        {
+            fixup_parent = successor->parent;
+            rb_transplant(tree, successor, successor->right);
+            successor->right = node->right;
+            successor->right->parent = successor;
+        }
+        rb_transplant(tree, node, successor);
+        successor->left = node->left;
+        successor->left->parent = successor;
+        successor->red = node->red;
+    }
+    --tree->size;
+
+    if (removed_red)
+    {
+        return true;
+    }
+
+    // Removed a black node, push the missing black back up
+    while (fixup_node != tree->root && !rb_is_red(fixup_node))
+    {
+        if (fixup_node == fixup_parent->left)
+        {
+            rb_node_t *sibling = fixup_parent->right;
+            if (rb_is_red(sibling))
+            {
+                sibling->red = false;
+                fixup_parent->red = true;
+                rb_rotate_left(tree, fixup_parent);
+                sibling = fixup_parent->right;
+            }
+            if (!rb_is_red(sibling->left) && !rb_is_red(sibling->right))
+            {
+                sibling->red = true;
+                fixup_node = fixup_parent;
+                fixup_parent = fixup_node->parent;
+                continue;
+            }
+            if (!rb_is_red(sibling->right))
+            {
+                sibling->left->red = false;
+                sibling->red = true;
+                rb_rotate_right(tree, sibling);
+                sibling = fixup_parent->right;
+            }
+            sibling->red = fixup_parent->red;
+            fixup_parent->red = false;
+            sibling->right->red = false;
+            rb_rotate_left(tree, fixup_parent);
+        }
+        else
+        {
+            rb_node_t *sibling = fixup_parent->left;
+            if (rb_is_red(sibling))
+            {
+                sibling->red = false;
+                fixup_parent->red = true;
+                rb_rotate_right(tree, fixup_parent);
+                sibling = fixup_parent->left;
+            }
+            if (!rb_is_red(sibling->left) && !rb_is_red(sibling->right))
+            {
+                sibling->red = true;
+                fixup_node = fixup_parent;
+                fixup_parent = fixup_node->parent;
+                continue;
+            }
+            if (!rb_is_red(sibling->left))
+            {
+                sibling->right->red = false;
+                sibling->red = true;
+                rb_rotate_left(tree, sibling);
+                sibling = fixup_parent->left;
+            }
+            sibling->red = fixup_parent->red;
+            fixup_parent->red = false;
+            sibling->left->red = false;
+            rb_rotate_right(tree, fixup_parent);
+        }
+        fixup_node = tree->root;
+        break;
+    }
+    if (fixup_node)
+    {
+        fixup_node->red = false;
+    }
+    return true;
+}
+
+rb_node_t *rb_tree_first(const rb_tree_t *const tree)
+{
+    if (tree)
+    {
+        return tree->leftmost;
+    }
+    return NULL;
+}
+
+rb_node_t *rb_tree_next(const rb_node_t *const node)
+{
+    if (!node)
+    {
+        return NULL;
+    }
+    if (node->right)
+    {
+        return rb_minimum(node->right);
+    }
+    const rb_node_t *walker = node;
+    while (walker->parent && walker == walker->parent->right)
+    {
+        walker = walker->parent;
+    }
+    return walker->parent;
+}
+
+size_t rb_tree_size(const rb_tree_t *const tree)
+{
+    if (tree)
+    {
+        return tree->size;
+    }
+    return 0;
+}
@@ -0,0 +1,160 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "dyn_array.h"
+#include "processing_scheduling.h"
+
+// Times dyn_array_sort against dyn_array_sort_parallel over a spread of thread counts, sorting PCBs by
+// burst time the way SJF does. Inputs are either a PCB file or generated in the style of the LargeFile test
+// (bursts cycling through 0-9, so lots of equal keys) and with random bursts.
+
+#define DEFAULT_PCB_COUNT 10000000
+#define DEFAULT_REPEATS 3
+
+static double seconds_between(const struct timespec *start, const struct timespec *end)
+{
+    return (double) (end->tv_sec - start->tv_sec) + (double) (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static int compare_burst_time(const void *a, const void *b)
+{
+    const uint32_t burst_a = ((const ProcessControlBlock_t *) a)->remaining_burst_time;
+    const uint32_t burst_b = ((const ProcessControlBlock_t *) b)->remaining_burst_time;
+    return (burst_a > burst_b) - (burst_a < burst_b);
+}
+
+// Best of repeats for sorting a fresh copy of the input, threads == 1 being the plain serial sort
+static double time_sort(const dyn_array_t *input, dyn_array_t *work, const size_t threads, const size_t repeats)
+{
+    double best = 0;
+    for (size_t run = 0; run < repeats; ++run)
+    {
+        dyn_array_clear(work);
+        dyn_array_append(work, dyn_array_front(input), dyn_array_size(input));
+
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        if (threads == 1)
+        {
+            dyn_array_sort(work, compare_burst_time);
+        }
+        else
+        {
+            dyn_array_sort_parallel(work, compare_burst_time, threads);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        const double seconds = seconds_between(&start, &end);
+        if (run == 0 || seconds < best)
+        {
+            best = seconds;
+        }
+    }
+    return best;
+}
+
+static bool sorted(const dyn_array_t *work)
+{
+    for (size_t i = 1; i < dyn_array_size(work); ++i)
+    {
+        if (compare_burst_time(dyn_array_at(work, i - 1), dyn_array_at(work, i)) > 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool benchmark(const char *name, const dyn_array_t *input, const size_t max_threads, const size_t repeats)
+{
+    dyn_array_t *work = dyn_array_create(dyn_array_size(input), sizeof(ProcessControlBlock_t), NULL);
+    if (!work)
+    {
+        return false;
+    }
+
+    printf("%s: %zu PCBs\n", name, dyn_array_size(input));
+    printf("%8s %12s %8s\n", "threads", "seconds", "speedup");
+    const double serial = time_sort(input, work, 1, repeats);
+    printf("%8s %12.6f %8.2f\n", "serial", serial, 1.0);
+    bool success = sorted(work);
+    for (size_t threads = 2; threads <= max_threads && success; threads *= 2)
+    {
+        const double seconds = time_sort(input, work, threads, repeats);
+        printf("%8zu %12.6f %8.2f\n", threads, seconds, seconds > 0 ? serial / seconds : 0.0);
+        success = sorted(work);
+    }
+    if (!success)
+    {
+        printf("%s: output not sorted\n", name);
+    }
+    dyn_array_destroy(work);
+    return success;
+}
+
+int main(int argc, char **argv)
+{
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t max_threads = online > 1 ? (size_t) online : 2;
+    size_t repeats = DEFAULT_REPEATS;
+    size_t count = DEFAULT_PCB_COUNT;
+    const char *pcb_file = NULL;
+
+    if (argc > 4 || (argc > 1 && strcmp(argv[1], "--help") == 0))
+    {
+        printf("%s [pcb count | pcb file] [max threads] [repeats]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (argc > 1)
+    {
+        char *end;
+        count = strtoul(argv[1], &end, 10);
+        if (*end != '\0')
+        {
+            pcb_file = argv[1];
+        }
+    }
+    if (argc > 2)
+    {
+        max_threads = strtoul(argv[2], NULL, 10);
+    }
+    if (argc > 3)
+    {
+        repeats = strtoul(argv[3], NULL, 10) ? strtoul(argv[3], NULL, 10) : 1;
+    }
+
+    if (pcb_file)
+    {
+        dyn_array_t *input = load_process_control_blocks(pcb_file);
+        if (!input)
+        {
+            printf("Couldn't load %s\n", pcb_file);
+            return EXIT_FAILURE;
+        }
+        bool success = benchmark(pcb_file, input, max_threads, repeats);
+        dyn_array_destroy(input);
+        return success ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    dyn_array_t *cyclic = dyn_array_create(count, sizeof(ProcessControlBlock_t), NULL);
+    dyn_array_t *random = dyn_array_create(count, sizeof(ProcessControlBlock_t), NULL);
+    bool success = cyclic && random;
+    srand(520);
+    for (size_t i = 0; i < count && success; ++i)
+    {
+        ProcessControlBlock_t pcb = {(uint32_t) (i % 10), 0, (uint32_t) i, false};
+        success = dyn_array_push_back(cyclic, &pcb);
+        pcb.remaining_burst_time = (uint32_t) rand();
+        success = success && dyn_array_push_back(random, &pcb);
+    }
+    success = success && benchmark("LargeFile-style bursts", cyclic, max_threads, repeats)
+              && benchmark("random bursts", random, max_threads, repeats);
+    dyn_array_destroy(cyclic);
+    dyn_array_destroy(random);
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
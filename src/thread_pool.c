@@ -0,0 +1,178 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "thread_pool.h"
+
+#ifndef THREAD_POOL_MAX_THREADS
+#define THREAD_POOL_MAX_THREADS 256
+#endif
+
+// Tasks are coarse (a chunk of an array each), so they're handed out under the one lock rather than
+// through anything cleverer. A run is over when pending reaches 0, busy keeps a second run from
+// starting until the first has returned.
+
+struct thread_pool
+{
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;      // workers wait here for a run or for stopping
+    pthread_cond_t work_done;       // callers wait here for their tasks, or their turn
+    pthread_t *workers;
+    size_t worker_count;
+
+    void (*task)(const size_t, void *);
+    void *arg;
+    size_t task_count;
+    size_t next_task;
+    size_t pending;                 // tasks of the current run not finished yet
+    bool busy;
+    bool stopping;
+};
+
+// Runs tasks of the current run until there are none left to claim, called and returns with the lock held
+static void thread_pool_work(thread_pool_t *const pool)
+{
+    while (pool->next_task < pool->task_count)
+    {
+        const size_t index = pool->next_task++;
+        pthread_mutex_unlock(&pool->lock);
+        pool->task(index, pool->arg);
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->pending == 0)
+        {
+            pthread_cond_broadcast(&pool->work_done);
+        }
+    }
+}
+
+static void *thread_pool_worker(void *arg)
+{
+    thread_pool_t *const pool = (thread_pool_t *) arg;
+    pthread_mutex_lock(&pool->lock);
+    while (!pool->stopping)
+    {
+        if (pool->next_task < pool->task_count)
+        {
+            thread_pool_work(pool);
+        }
+        else
+        {
+            pthread_cond_wait(&pool->work_ready, &pool->lock);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+thread_pool_t *thread_pool_create(const size_t threads)
+{
+    size_t thread_count = threads;
+    if (!thread_count)
+    {
+        const long online = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_count = online > 0 ? (size_t) online : 1;
+    }
+
+    if (thread_count > THREAD_POOL_MAX_THREADS)
+    {
+        thread_count = THREAD_POOL_MAX_THREADS;
+    }
+
+    thread_pool_t *pool = (thread_pool_t *) calloc(1, sizeof(thread_pool_t));
+    if (!pool)
+    {
+        return NULL;
+    }
+    pool->workers = (pthread_t *) malloc(thread_count * sizeof(pthread_t));
+    const bool lock = pthread_mutex_init(&pool->lock, NULL) == 0;
+    const bool ready = lock && pthread_cond_init(&pool->work_ready, NULL) == 0;
+    const bool done = ready && pthread_cond_init(&pool->work_done, NULL) == 0;
+    if (!pool->workers || !done)
+    {
+        if (done)
+        {
+            pthread_cond_destroy(&pool->work_done);
+        }
+        if (ready)
+        {
+            pthread_cond_destroy(&pool->work_ready);
+        }
+        if (lock)
+        {
+            pthread_mutex_destroy(&pool->lock);
+        }
+        free(pool->workers);
+        free(pool);
+        return NULL;
+    }
+
+    while (pool->worker_count + 1 < thread_count
+           && pthread_create(&pool->workers[pool->worker_count], NULL, thread_pool_worker, pool) == 0)
+    {
+        ++pool->worker_count;
+    }
+    return pool;
+}
+
+void thread_pool_destroy(thread_pool_t *const pool)
+{
+    if (pool)
+    {
+        pthread_mutex_lock(&pool->lock);
+        pool->stopping = true;
+        pthread_cond_broadcast(&pool->work_ready);
+        pthread_mutex_unlock(&pool->lock);
+        for (size_t i = 0; i < pool->worker_count; ++i)
+        {
+            pthread_join(pool->workers[i], NULL);
+        }
+        pthread_cond_destroy(&pool->work_done);
+        pthread_cond_destroy(&pool->work_ready);
+        pthread_mutex_destroy(&pool->lock);
+        free(pool->workers);
+        free(pool);
+    }
+}
+
+size_t thread_pool_size(const thread_pool_t *const pool)
+{
+    return pool ? pool->worker_count + 1 : 1;
+}
+
+bool thread_pool_run(thread_pool_t *const pool, void (*const task)(const size_t, void *), void *arg,
+                     const size_t tasks)
+{
+    if (!pool || !task)
+    {
+        return false;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->busy)
+    {
+        pthread_cond_wait(&pool->work_done, &pool->lock);
+    }
+    pool->busy = true;
+    pool->task = task;
+    pool->arg = arg;
+    pool->task_count = tasks;
+    pool->next_task = 0;
+    pool->pending = tasks;
+    if (tasks > 1)
+    {
+        pthread_cond_broadcast(&pool->work_ready);
+    }
+
+    thread_pool_work(pool);
+    while (pool->pending)
+    {
+        pthread_cond_wait(&pool->work_done, &pool->lock);
+    }
+    pool->task_count = 0;
+    pool->next_task = 0;
+    pool->busy = false;
+    pthread_cond_broadcast(&pool->work_done);
+    pthread_mutex_unlock(&pool->lock);
+    return true;
+}
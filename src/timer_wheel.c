@@ -0,0 +1,332 @@
+#include <string.h>
+
+#include "timer_wheel.h"
+
+// Marks an empty slot / the end of a chain
+#define TW_NONE UINT32_MAX
+// Slot value of a node sitting on the free list
+#define TW_FREE UINT16_MAX
+
+#define TW_SLOT_MASK ((uint64_t) (TIMER_WHEEL_SLOTS - 1))
+
+typedef struct
+{
+    uint64_t expiry;
+    uint64_t value;
+    uint32_t next;          // next node in the slot (or free list)
+    uint32_t prev;          // previous node in the slot
+    uint32_t generation;    // bumped every time the node is freed, so stale ids don't cancel a reused node
+    uint16_t slot;          // level * TIMER_WHEEL_SLOTS + slot index, TW_FREE if not pending
+}
+tw_node_t;
+
+#define TW_NODES(wheel_ptr) ((tw_node_t *) (wheel_ptr)->nodes->array)
+
+// Level a timer belongs on: the level of the highest bit where expiry and the clock differ
+static inline size_t tw_level(const uint64_t now, const uint64_t expiry)
+{
+    const uint64_t diff = (expiry ^ now) >> TIMER_WHEEL_LEVEL_BITS;
+    if (!diff)
+    {
+        return 0;
+    }
+    return (size_t) (63 - __builtin_clzll(diff)) / TIMER_WHEEL_LEVEL_BITS + 1;
+}
+
+static inline size_t tw_index(const uint64_t time, const size_t level)
+{
+    return (size_t) ((time >> (level * TIMER_WHEEL_LEVEL_BITS)) & TW_SLOT_MASK);
+}
+
+// Appends a node to the slot its expiry maps to from the current clock
+static void tw_link(timer_wheel_t *const wheel, tw_node_t *const nodes, const uint32_t node_idx)
+{
+    tw_node_t *node = &nodes[node_idx];
+    const size_t level = tw_level(wheel->now, node->expiry);
+    const size_t index = tw_index(node->expiry, level);
+
+    node->slot = (uint16_t) (level * TIMER_WHEEL_SLOTS + index);
+    node->next = TW_NONE;
+    node->prev = wheel->tail[level][index];
+    if (node->prev == TW_NONE)
+    {
+        wheel->head[level][index] = node_idx;
+        wheel->occupied[level] |= (uint64_t) 1 << index;
+    }
+    else
+    {
+        nodes[node->prev].next = node_idx;
+    }
+    wheel->tail[level][index] = node_idx;
+}
+
+static void tw_unlink(timer_wheel_t *const wheel, tw_node_t *const nodes, const uint32_t node_idx)
+{
+    tw_node_t *node = &nodes[node_idx];
+    const size_t level = node->slot / TIMER_WHEEL_SLOTS;
+    const size_t index = node->slot % TIMER_WHEEL_SLOTS;
+
+    if (node->prev == TW_NONE)
+    {
+        wheel->head[level][index] = node->next;
+    }
+    else
+    {
+        nodes[node->prev].next = node->next;
+    }
+    if (node->next == TW_NONE)
+    {
+        wheel->tail[level][index] = node->prev;
+    }
+    else
+    {
+        nodes[node->next].prev = node->prev;
+    }
+    if (wheel->head[level][index] == TW_NONE)
+    {
+        wheel->occupied[level] &= ~((uint64_t) 1 << index);
+    }
+}
+
+static void tw_free(timer_wheel_t *const wheel, tw_node_t *const nodes, const uint32_t node_idx)
+{
+    nodes[node_idx].slot = TW_FREE;
+    ++nodes[node_idx].generation;
+    nodes[node_idx].next = wheel->free_list;
+    wheel->free_list = node_idx;
+    --wheel->size;
+}
+
+// Moves every timer in a slot down to where it belongs from the (just advanced) clock, keeping their order
+static void tw_cascade(timer_wheel_t *const wheel, const size_t level, const size_t index)
+{
+    tw_node_t *nodes = TW_NODES(wheel);
+    uint32_t node_idx = wheel->head[level][index];
+    wheel->head[level][index] = wheel->tail[level][index] = TW_NONE;
+    wheel->occupied[level] &= ~((uint64_t) 1 << index);
+    while (node_idx != TW_NONE)
+    {
+        const uint32_t next = nodes[node_idx].next;
+        tw_link(wheel, nodes, node_idx);
+        node_idx = next;
+    }
+}
+
+// Occupied slots at a level strictly after the clock's slot at that level
+static inline uint64_t tw_later_slots(const timer_wheel_t *const wheel, const size_t level)
+{
+    const size_t current = tw_index(wheel->now, level);
+    if (current == TW_SLOT_MASK)
+    {
+        return 0;
+    }
+    return wheel->occupied[level] & (~(uint64_t) 0 << (current + 1));
+}
+
+// Start of the given slot in the clock's current window at a level
+static inline uint64_t tw_slot_start(const uint64_t now, const size_t level, const size_t index)
+{
+    const size_t shift = level * TIMER_WHEEL_LEVEL_BITS;
+    const size_t window_shift = shift + TIMER_WHEEL_LEVEL_BITS;
+    uint64_t window = window_shift < 64 ? (now >> window_shift) << window_shift : 0;
+    return window | ((uint64_t) index << shift);
+}
+
+timer_wheel_t *timer_wheel_create(const uint64_t start_time, const size_t capacity)
+{
+    timer_wheel_t *wheel = (timer_wheel_t *) malloc(sizeof(timer_wheel_t));
+    if (wheel)
+    {
+        memset(wheel->head, 0xFF, sizeof(wheel->head));
+        memset(wheel->tail, 0xFF, sizeof(wheel->tail));
+        memset(wheel->occupied, 0, sizeof(wheel->occupied));
+        wheel->free_list = TW_NONE;
+        wheel->now = start_time;
+        wheel->size = 0;
+        wheel->nodes = dyn_array_create(capacity, sizeof(tw_node_t), NULL);
+        if (wheel->nodes)
+        {
+            return wheel;
+        }
+        free(wheel);
+    }
+    return NULL;
+}
+
+void timer_wheel_destroy(timer_wheel_t *const wheel)
+{
+    if (wheel)
+    {
+        dyn_array_destroy(wheel->nodes);
+        free(wheel);
+    }
+}
+
+bool timer_wheel_insert(timer_wheel_t *const wheel, const uint64_t expiry, const uint64_t value, uint64_t *const id)
+{
+    if (!wheel || expiry < wheel->now)
+    {
+        return false;
+    }
+
+    uint32_t node_idx = wheel->free_list;
+    if (node_idx != TW_NONE)
+    {
+        wheel->free_list = TW_NODES(wheel)[node_idx].next;
+    }
+    else
+    {
+        if (dyn_array_size(wheel->nodes) >= TW_NONE)
+        {
+            return false;
+        }
+        const tw_node_t fresh = {0, 0, TW_NONE, TW_NONE, 0, TW_FREE};
+        node_idx = (uint32_t) dyn_array_size(wheel->nodes);
+        if (!dyn_array_push_back(wheel->nodes, &fresh))
+        {
+            return false;
+        }
+    }
+
+    tw_node_t *nodes = TW_NODES(wheel);
+    nodes[node_idx].expiry = expiry;
+    nodes[node_idx].value = value;
+    tw_link(wheel, nodes, node_idx);
+    ++wheel->size;
+    if (id)
+    {
+        *id = ((uint64_t) nodes[node_idx].generation << 32) | node_idx;
+    }
+    return true;
+}
+
+bool timer_wheel_cancel(timer_wheel_t *const wheel, const uint64_t id)
+{
+    const uint32_t node_idx = (uint32_t) id;
+    if (!wheel || node_idx >= dyn_array_size(wheel->nodes))
+    {
+        return false;
+    }
+    tw_node_t *nodes = TW_NODES(wheel);
+    if (nodes[node_idx].slot == TW_FREE || nodes[node_idx].generation != (uint32_t) (id >> 32))
+    {
+        return false;
+    }
+    tw_unlink(wheel, nodes, node_idx);
+    tw_free(wheel, nodes, node_idx);
+    return true;
+}
+
+bool timer_wheel_pop(timer_wheel_t *const wheel, const uint64_t until, uint64_t *const expiry, uint64_t *const value)
+{
+    if (!wheel)
+    {
+        return false;
+    }
+
+    while (wheel->size)
+    {
+        // Level 0 slots are single ticks, so the first occupied one from the clock on holds the earliest timer
+        const uint64_t due = wheel->occupied[0] & (~(uint64_t) 0 << tw_index(wheel->now, 0));
+        if (due)
+        {
+            const size_t index = (size_t) __builtin_ctzll(due);
+            const uint64_t time = tw_slot_start(wheel->now, 0, index);
+            if (time > until)
+            {
+                return false;
+            }
+            wheel->now = time;
+
+            tw_node_t *nodes = TW_NODES(wheel);
+            const uint32_t node_idx = wheel->head[0][index];
+            if (expiry)
+            {
+                *expiry = nodes[node_idx].expiry;
+            }
+            if (value)
+            {
+                *value = nodes[node_idx].value;
+            }
+            tw_unlink(wheel, nodes, node_idx);
+            tw_free(wheel, nodes, node_idx);
+            return true;
+        }
+
+        // Nothing left in this level 0 window, the next timers are in the nearest later slot further up
+        size_t level = 1;
+        uint64_t later = 0;
+        while (level < TIMER_WHEEL_LEVELS && !(later = tw_later_slots(wheel, level)))
+        {
+            ++level;
+        }
+        if (level == TIMER_WHEEL_LEVELS)
+        {
+            return false;   // can't happen while the size is right
+        }
+        const size_t index = (size_t) __builtin_ctzll(later);
+        const uint64_t start = tw_slot_start(wheel->now, level, index);
+        if (start > until)
+        {
+            return false;
+        }
+        wheel->now = start;
+        tw_cascade(wheel, level, index);
+    }
+    return false;
+}
+
+bool timer_wheel_peek(const timer_wheel_t *const wheel, uint64_t *const expiry)
+{
+    if (!wheel || !expiry || !wheel->size)
+    {
+        return false;
+    }
+
+    const uint64_t due = wheel->occupied[0] & (~(uint64_t) 0 << tw_index(wheel->now, 0));
+    if (due)
+    {
+        *expiry = tw_slot_start(wheel->now, 0, (size_t) __builtin_ctzll(due));
+        return true;
+    }
+
+    // The earliest timer is somewhere in the nearest later slot up the levels, which isn't sorted
+    for (size_t level = 1; level < TIMER_WHEEL_LEVELS; ++level)
+    {
+        const uint64_t later = tw_later_slots(wheel, level);
+        if (later)
+        {
+            const tw_node_t *nodes = TW_NODES(wheel);
+            uint64_t earliest = UINT64_MAX;
+            for (uint32_t node_idx = wheel->head[level][__builtin_ctzll(later)]; node_idx != TW_NONE;
+                 node_idx = nodes[node_idx].next)
+            {
+                if (nodes[node_idx].expiry < earliest)
+                {
+                    earliest = nodes[node_idx].expiry;
+                }
+            }
+            *expiry = earliest;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t timer_wheel_now(const timer_wheel_t *const wheel)
+{
+    if (wheel)
+    {
+        return wheel->now;
+    }
+    return 0;
+}
+
+size_t timer_wheel_size(const timer_wheel_t *const wheel)
+{
+    if (wheel)
+    {
+        return wheel->size;
+    }
+    return 0;
+}
@@ -1,8 +1,18 @@
+#include <cmath>
 #include <fcntl.h>
 #include <stdio.h>
 #include "gtest/gtest.h"
 #include <pthread.h>
 #include "../include/processing_scheduling.h"
+#include "../include/multicore_scheduling.h"
+#include "../include/concurrent_queue.h"
+#include "../include/online_scheduler.h"
+#include "../include/multi_burst.h"
+#include "../include/timer_wheel.h"
+#include "../include/instrumentation.h"
+#include "../include/pcb_table.h"
+#include "../include/dyn_array.hpp"
+#include "../include/thread_pool.h"
 
 // Using a C library requires extern "C" to prevent function managling
 extern "C" 
@@ -304,6 +314,25 @@ TEST(load_process_control_blocks, LargeFile) {
     dyn_array_destroy(result);
 }
 
+// Preemptive, so unlike SJF every hand-off to a different PCB costs the switch time
+TEST(shortest_remaining_time_first, ContextSwitchCost) {
+    ProcessControlBlock_t pcbs[] = { {5, 0, 0, false}, {3, 1, 1, false}, {7, 2, 2, false} };
+    dyn_array_t* ready_queue = dyn_array_create(3, sizeof(ProcessControlBlock_t), NULL);
+    dyn_array_append(ready_queue, pcbs, 3);
+    ScheduleResult_t result;
+    set_context_switch_cost(1);
+    // pcb1 0-1, switch, pcb2 2-5, switch, pcb1 6-10, switch, pcb3 11-18
+    ASSERT_TRUE(shortest_remaining_time_first_readonly(ready_queue, &result));
+    ASSERT_EQ(18ul, result.total_run_time);
+    ASSERT_EQ(3ul, result.context_switches);
+    ASSERT_EQ(3ul, result.switch_overhead);
+    ASSERT_TRUE(shortest_job_first_readonly(ready_queue, &result));
+    ASSERT_EQ(15ul, result.total_run_time);
+    ASSERT_EQ(0ul, result.context_switches);
+    set_context_switch_cost(0);
+    dyn_array_destroy(ready_queue);
+}
+
 //Null ready queue for shortest job first
 TEST(shortest_remaining_time_first, NullPointers) {
     dyn_array_t* ready_queue = NULL; //Create A null ready queue
@@ -315,15 +344,13 @@ TEST(shortest_remaining_time_first, NullPointers) {
 
 
 
-// first_come_first_serve TEST 2: Ensure the function returns false when the ready_queue is empty
+// shortest_remaining_time_first TEST 2: Ensure the function returns false when the ready_queue is empty
 TEST(shortest_remaining_time_first, EmptyQueue) {
-    dyn_array_t* ready_queue =  dyn_array_create(1, sizeof(ProcessControlBlock_t), NULL);;
+    dyn_array_t* ready_queue =  dyn_array_create(1, sizeof(ProcessControlBlock_t), NULL);
     ScheduleResult_t result;
-    ProcessControlBlock_t pcb1 = { .remaining_burst_time = 5, .priority = 0, .arrival = 0, .started = false };
-    dyn_array_push_back(ready_queue,&pcb1);
     ASSERT_EQ(false, shortest_remaining_time_first(ready_queue, &result));
     
-    free(ready_queue);
+    dyn_array_destroy(ready_queue);
 }
 
 // Test case for a non-empty ready queue with multiple processes
@@ -343,12 +370,12 @@ TEST(shortest_remaining_time_first, NonEmptyQueue) {
     // Running the shortest_remaining_time_first algorithm
     ASSERT_EQ(true, shortest_remaining_time_first(ready_queue, &result));
 
-    // Validating the results
-    ASSERT_EQ(5.0f, result.average_waiting_time); // Waiting time is sum of run times = 0+3+8 = 11 / 3 = 3.666...
-    ASSERT_FLOAT_EQ(5.6666665f, result.average_turnaround_time); // Turnaround time is sum of burst times = 5+3+7 = 15 / 3 = 5.0
+    // Validating the results, pcb2 preempts pcb1 at 1: pcb1 0-1, pcb2 1-4, pcb1 4-8, pcb3 8-15
+    ASSERT_FLOAT_EQ(2.0f, result.average_waiting_time); // Waiting time to first dispatch = 0+0+6 = 6 / 3 = 2
+    ASSERT_FLOAT_EQ(8.0f, result.average_turnaround_time); // Turnaround time = 8+3+13 = 24 / 3 = 8
     ASSERT_EQ(15ul, result.total_run_time); // Total run time is sum of burst times = 5+3+7 = 15
 
-    free(ready_queue);
+    dyn_array_destroy(ready_queue);
 }
 
 // Test case for processes with varying burst times
@@ -368,12 +395,12 @@ TEST(shortest_remaining_time_first, VaryingBurstTimes) {
     // Running the shortest_remaining_time_first algorithm
     ASSERT_EQ(true, shortest_remaining_time_first(ready_queue, &result));
 
-    // Validating the results
-    ASSERT_EQ(5.0f, result.average_waiting_time); // Waiting time is sum of run times = 0+8+3 = 11 / 3 = 3.666...
-    ASSERT_FLOAT_EQ(5.0f, result.average_turnaround_time); // Turnaround time is sum of burst times = 8+2+5 = 15 / 3 = 5.0
+    // Validating the results, everything arrives at once so it runs 2, 5, 8
+    ASSERT_FLOAT_EQ(3.0f, result.average_waiting_time); // Waiting time = 0+2+7 = 9 / 3 = 3
+    ASSERT_FLOAT_EQ(8.0f, result.average_turnaround_time); // Turnaround time = 2+7+15 = 24 / 3 = 8
     ASSERT_EQ(15ul, result.total_run_time); // Total run time is sum of burst times = 8+2+5 = 15
 
-    free(ready_queue);
+    dyn_array_destroy(ready_queue);
 }
 
 //Null ready queue for shortest job first
@@ -387,15 +414,13 @@ TEST(shortest_job_first, NullPointers) {
 
 
 
-// first_come_first_serve TEST 2: Ensure the function returns false when the ready_queue is empty
+// shortest_job_first TEST 2: Ensure the function returns false when the ready_queue is empty
 TEST(shortest_job_first, EmptyQueue) {
-    dyn_array_t* ready_queue =  dyn_array_create(1, sizeof(ProcessControlBlock_t), NULL);;
+    dyn_array_t* ready_queue =  dyn_array_create(1, sizeof(ProcessControlBlock_t), NULL);
     ScheduleResult_t result;
-    ProcessControlBlock_t pcb1 = { .remaining_burst_time = 5, .priority = 0, .arrival = 0, .started = false };
-    dyn_array_push_back(ready_queue,&pcb1);
     ASSERT_EQ(false, shortest_job_first(ready_queue, &result));
     
-    free(ready_queue);
+    dyn_array_destroy(ready_queue);
 }
 
 // Test case for a non-empty ready queue with multiple processes
@@ -415,12 +440,12 @@ TEST(shortest_job_first, NonEmptyQueue) {
     // Running the shortest_job_first algorithm
     ASSERT_EQ(true, shortest_job_first(ready_queue, &result));
 
-    // Validating the results
-    ASSERT_EQ(4.0f, result.average_waiting_time); // Waiting time is sum of run times = 0+3+9 = 13 / 3 = 4.0
-    ASSERT_FLOAT_EQ(6.0f, result.average_turnaround_time); // Turnaround time is sum of burst times = 5+3+7 = 15 / 3 = 5.0
-    ASSERT_EQ(18ul, result.total_run_time); // Total run time is sum of burst times = 5+3+7 = 15
+    // Validating the results, pcb1 is alone at 0 so it runs first: pcb1 0-6, pcb2 6-9, pcb3 9-18
+    ASSERT_FLOAT_EQ(4.0f, result.average_waiting_time); // Waiting time = 0+5+7 = 12 / 3 = 4
+    ASSERT_FLOAT_EQ(10.0f, result.average_turnaround_time); // Turnaround time = 6+8+16 = 30 / 3 = 10
+    ASSERT_EQ(18ul, result.total_run_time); // Total run time is sum of burst times = 6+3+9 = 18
 
-    free(ready_queue);
+    dyn_array_destroy(ready_queue);
 }
 
 // Test case for processes with varying burst times
@@ -437,15 +462,1285 @@ TEST(shortest_job_first, VaryingBurstTimes) {
     dyn_array_push_back(ready_queue, &pcb2);
     dyn_array_push_back(ready_queue, &pcb3);
 
-    // Running the shortest_remaining_time_first algorithm
+    // Running the shortest_job_first algorithm
     ASSERT_EQ(true, shortest_job_first(ready_queue, &result));
 
-    // Validating the results
-    ASSERT_EQ(5.0f, result.average_waiting_time); // Waiting time is sum of run times = 0+3+12 = 15 / 3 = 5
-    ASSERT_FLOAT_EQ(7.666f, result.average_turnaround_time); // Turnaround time is sum of burst times = 11+3+9 = 23 / 3 = 7.666
+    // Validating the results, everything arrives at once so it runs 3, 9, 11
+    ASSERT_FLOAT_EQ(5.0f, result.average_waiting_time); // Waiting time = 0+3+12 = 15 / 3 = 5
+    ASSERT_FLOAT_EQ(38.0f / 3, result.average_turnaround_time); // Turnaround time = 3+12+23 = 38 / 3
     ASSERT_EQ(23ul, result.total_run_time); // Total run time is sum of burst times = 11+3+9 = 23
 
-    free(ready_queue);
+    // The PCBs were run where they are, in the order they were queued
+    for (size_t i = 0; i < dyn_array_size(ready_queue); ++i) {
+        ProcessControlBlock_t *pcb = (ProcessControlBlock_t *)dyn_array_at(ready_queue, i);
+        ASSERT_EQ(i, pcb->priority);
+        ASSERT_EQ(0u, pcb->remaining_burst_time);
+        ASSERT_TRUE(pcb->started);
+    }
+
+    dyn_array_destroy(ready_queue);
+}
+
+// multicore_schedule TEST 1: Ensure the function returns false on NULL input or a bad CPU count
+TEST(multicore_schedule, InvalidInput) {
+    dyn_array_t* ready_queue = dyn_array_create(1, sizeof(ProcessControlBlock_t), NULL);
+    ProcessControlBlock_t pcb1 = { .remaining_burst_time = 5, .priority = 0, .arrival = 0, .started = false };
+    dyn_array_push_back(ready_queue, &pcb1);
+
+    MulticoreConfig_t config = { .cpu_count = 0, .policy = POLICY_FCFS, .queue_mode = QUEUE_GLOBAL, .quantum = 0, .work_stealing = false,
+                                 .steal_policy = STEAL_MOST_LOADED, .steal_half = false, .switch_cost = 0, .migration_cost = 0, .steal_seed = 0 };
+    MulticoreResult_t result;
+    ASSERT_EQ(false, multicore_schedule(NULL, &config, &result));
+    ASSERT_EQ(false, multicore_schedule(ready_queue, &config, &result));
+    config.cpu_count = MULTICORE_MAX_CPUS + 1;
+    ASSERT_EQ(false, multicore_schedule(ready_queue, &config, &result));
+
+    dyn_array_destroy(ready_queue);
+}
+
+// Two CPUs sharing one FCFS queue, each free CPU takes the next PCB in line
+TEST(multicore_schedule, GlobalQueueFCFS) {
+    dyn_array_t* ready_queue = dyn_array_create(4, sizeof(ProcessControlBlock_t), NULL);
+    ProcessControlBlock_t pcbs[4] = {
+        { .remaining_burst_time = 5, .priority = 0, .arrival = 0, .started = false },
+        { .remaining_burst_time = 3, .priority = 0, .arrival = 0, .started = false },
+        { .remaining_burst_time = 7, .priority = 0, .arrival = 0, .started = false },
+        { .remaining_burst_time = 2, .priority = 0, .arrival = 0, .started = false } };
+    for (size_t i = 0; i < 4; ++i) {
+        dyn_array_push_back(ready_queue, &pcbs[i]);
+    }
+
+    MulticoreConfig_t config = { .cpu_count = 2, .policy = POLICY_FCFS, .queue_mode = QUEUE_GLOBAL, .quantum = 0, .work_stealing = false,
+                                 .steal_policy = STEAL_MOST_LOADED, .steal_half = false, .switch_cost = 0, .migration_cost = 0, .steal_seed = 0 };
+    MulticoreResult_t result;
+    ASSERT_TRUE(multicore_schedule(ready_queue, &config, &result));
+
+    // CPU 0 runs 5 then 2, CPU 1 runs 3 then 7
+    ASSERT_FLOAT_EQ(2.0f, result.schedule.average_waiting_time);
+    ASSERT_FLOAT_EQ(6.25f, result.schedule.average_turnaround_time);
+    ASSERT_EQ(10ul, result.schedule.total_run_time);
+    ASSERT_EQ(7ul, result.cpu_busy_time[0]);
+    ASSERT_EQ(10ul, result.cpu_busy_time[1]);
+    ASSERT_NEAR(0.1765, result.load_imbalance, 0.001);
+
+    dyn_array_destroy(ready_queue);
+}
+
+// Per-CPU queues strand the long jobs on one CPU unless the idle one is allowed to steal
+TEST(multicore_schedule, PerCpuWorkStealing) {
+    dyn_array_t* ready_queue = dyn_array_create(4, sizeof(ProcessControlBlock_t), NULL);
+    ProcessControlBlock_t pcbs[4] = {
+        { .remaining_burst_time = 10, .priority = 0, .arrival = 0, .started = false },
+        { .remaining_burst_time = 1, .priority = 0, .arrival = 0, .started = false },
+        { .remaining_burst_time = 10, .priority = 0, .arrival = 0, .started = false },
+        { .remaining_burst_time = 1, .priority = 0, .arrival = 0, .started = false } };
+
+    MulticoreConfig_t config = { .cpu_count = 2, .policy = POLICY_FCFS, .queue_mode = QUEUE_PER_CPU, .quantum = 0, .work_stealing = false,
+                                 .steal_policy = STEAL_MOST_LOADED, .steal_half = false, .switch_cost = 0, .migration_cost = 0, .steal_seed = 0 };
+    MulticoreResult_t result;
+
+    for (size_t i = 0; i < 4; ++i) {
+        dyn_array_push_back(ready_queue, &pcbs[i]);
+    }
+    ASSERT_TRUE(multicore_schedule(ready_queue, &config, &result));
+    ASSERT_EQ(20ul, result.schedule.total_run_time);
+    ASSERT_EQ(0ul, result.steals);
+    dyn_array_destroy(ready_queue);
+
+    ready_queue = dyn_array_create(4, sizeof(ProcessControlBlock_t), NULL);
+    for (size_t i = 0; i < 4; ++i) {
+        dyn_array_push_back(ready_queue, &pcbs[i]);
+    }
+    config.work_stealing = true;
+    ASSERT_TRUE(multicore_schedule(ready_queue, &config, &result));
+    ASSERT_EQ(12ul, result.schedule.total_run_time);
+    ASSERT_EQ(1ul, result.steals);
+    dyn_array_destroy(ready_queue);
+}
+
+// Preemptive policies on a single virtual CPU should match the textbook schedules
+TEST(multicore_schedule, PreemptivePolicies) {
+    dyn_array_t* ready_queue = dyn_array_create(2, sizeof(ProcessControlBlock_t), NULL);
+    ProcessControlBlock_t rr_pcbs[2] = {
+        { .remaining_burst_time = 3, .priority = 0, .arrival = 0, .started = false },
+        { .remaining_burst_time = 2, .priority = 0, .arrival = 0, .started = false } };
+    dyn_array_push_back(ready_queue, &rr_pcbs[0]);
+    dyn_array_push_back(ready_queue, &rr_pcbs[1]);
+
+    MulticoreConfig_t config = { .cpu_count = 1, .policy = POLICY_RR, .queue_mode = QUEUE_GLOBAL, .quantum = 2, .work_stealing = false,
+                                 .steal_policy = STEAL_MOST_LOADED, .steal_half = false, .switch_cost = 0, .migration_cost = 0, .steal_seed = 0 };
+    MulticoreResult_t result;
+    ASSERT_TRUE(multicore_schedule(ready_queue, &config, &result));
+    ASSERT_FLOAT_EQ(1.0f, result.schedule.average_waiting_time);
+    ASSERT_FLOAT_EQ(4.5f, result.schedule.average_turnaround_time);
+    ASSERT_EQ(5ul, result.schedule.total_run_time);
+    dyn_array_destroy(ready_queue);
+
+    ready_queue = dyn_array_create(2, sizeof(ProcessControlBlock_t), NULL);
+    ProcessControlBlock_t srtf_pcbs[2] = {
+        { .remaining_burst_time = 8, .priority = 0, .arrival = 0, .started = false },
+        { .remaining_burst_time = 2, .priority = 0, .arrival = 1, .started = false } };
+    dyn_array_push_back(ready_queue, &srtf_pcbs[0]);
+    dyn_array_push_back(ready_queue, &srtf_pcbs[1]);
+
+    config.policy = POLICY_SRTF;
+    ASSERT_TRUE(multicore_schedule(ready_queue, &config, &result));
+    ASSERT_FLOAT_EQ(0.0f, result.schedule.average_waiting_time);
+    ASSERT_FLOAT_EQ(6.0f, result.schedule.average_turnaround_time);
+    ASSERT_EQ(10ul, result.schedule.total_run_time);
+    dyn_array_destroy(ready_queue);
+}
+
+// Stolen PCBs come off the tail of the victim's queue and pay the migration cost on the thief
+TEST(multicore_schedule, StealFromTailWithMigrationCost) {
+    dyn_array_t* ready_queue = dyn_array_create(6, sizeof(ProcessControlBlock_t), NULL);
+    for (uint32_t i = 0; i < 6; ++i) {
+        ProcessControlBlock_t pcb = { .remaining_burst_time = (i % 2) ? 1u : 4u, .priority = 0, .arrival = 0, .started = false };
+        dyn_array_push_back(ready_queue, &pcb);
+    }
+
+    MulticoreConfig_t config = { .cpu_count = 2, .policy = POLICY_FCFS, .queue_mode = QUEUE_PER_CPU, .quantum = 0,
+                                 .work_stealing = true, .steal_policy = STEAL_MOST_LOADED, .steal_half = true,
+                                 .switch_cost = 0, .migration_cost = 3, .steal_seed = 0 };
+    MulticoreResult_t result;
+    ASSERT_TRUE(multicore_schedule(ready_queue, &config, &result));
+
+    // CPU 1 drains its short jobs by t=3, steals the last 4 from CPU 0 and warms up until t=6
+    ASSERT_EQ(10ul, result.schedule.total_run_time);
+    ASSERT_EQ(1ul, result.steals);
+    ASSERT_EQ(1ul, result.migrations);
+    ASSERT_EQ(3ul, result.migration_time);
+    ASSERT_EQ(8ul, result.cpu_busy_time[0]);
+    ASSERT_EQ(10ul, result.cpu_busy_time[1]);
+    ASSERT_EQ(3ul, result.turnaround_p50);
+    ASSERT_EQ(10ul, result.turnaround_p99);
+    ASSERT_EQ(10ul, result.turnaround_max);
+
+    dyn_array_destroy(ready_queue);
+}
+
+#define PRODUCERS 4
+#define PCBS_PER_PRODUCER 20000
+
+struct producer_arg {
+    concurrent_ring_t* ring;
+    concurrent_heap_t* heap;
+    uint32_t id;
+};
+
+// Pushes PCBs tagged with the producer id (priority) and a per-producer sequence (arrival)
+static void* ring_producer(void* arg) {
+    producer_arg* producer = (producer_arg*)arg;
+    ProcessControlBlock_t batch[4];
+    for (uint32_t i = 0; i < PCBS_PER_PRODUCER; i += 4) {
+        for (uint32_t j = 0; j < 4; ++j) {
+            batch[j] = { .remaining_burst_time = 1, .priority = producer->id, .arrival = i + j, .started = false };
+        }
+        while (!concurrent_ring_push_batch(producer->ring, batch, 4)) {
+            sched_yield(); // ring full, let the consumer catch up
+        }
+    }
+    return NULL;
+}
+
+// Many producers, one consumer: nothing lost and each producer's PCBs come out in the order they went in
+TEST(concurrent_ring, MultipleProducersKeepOrder) {
+    concurrent_ring_t* ring = concurrent_ring_create(1024, sizeof(ProcessControlBlock_t));
+    ASSERT_NE(nullptr, ring);
+
+    pthread_t threads[PRODUCERS];
+    producer_arg args[PRODUCERS];
+    for (uint32_t i = 0; i < PRODUCERS; ++i) {
+        args[i] = { ring, NULL, i };
+        pthread_create(&threads[i], NULL, ring_producer, &args[i]);
+    }
+
+    uint32_t next_expected[PRODUCERS] = { 0 };
+    size_t received = 0;
+    ProcessControlBlock_t batch[64];
+    while (received < PRODUCERS * PCBS_PER_PRODUCER) {
+        size_t count = concurrent_ring_pop_batch(ring, batch, 64);
+        for (size_t i = 0; i < count; ++i) {
+            ASSERT_LT(batch[i].priority, static_cast<uint32_t>(PRODUCERS));
+            ASSERT_EQ(next_expected[batch[i].priority], batch[i].arrival);
+            ++next_expected[batch[i].priority];
+        }
+        received += count;
+    }
+
+    for (uint32_t i = 0; i < PRODUCERS; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+    ProcessControlBlock_t leftover;
+    ASSERT_FALSE(concurrent_ring_pop(ring, &leftover));
+    concurrent_ring_destroy(ring);
+}
+
+static uint64_t burst_key(const void* const pcb) {
+    return ((const ProcessControlBlock_t*)pcb)->remaining_burst_time;
+}
+
+static void* heap_producer(void* arg) {
+    producer_arg* producer = (producer_arg*)arg;
+    ProcessControlBlock_t batch[16];
+    for (uint32_t i = 0; i < PCBS_PER_PRODUCER; i += 16) {
+        for (uint32_t j = 0; j < 16; ++j) {
+            batch[j] = { .remaining_burst_time = ((i + j) * 7919u + producer->id) % 1000u, .priority = producer->id, .arrival = i + j, .started = false };
+        }
+        concurrent_heap_push_batch(producer->heap, batch, 16);
+    }
+    return NULL;
+}
+
+// Concurrent batch pushes into the locked heap come back out shortest burst first
+TEST(concurrent_heap, ConcurrentPushesPopInOrder) {
+    concurrent_heap_t* heap = concurrent_heap_create(0, sizeof(ProcessControlBlock_t), burst_key);
+    ASSERT_NE(nullptr, heap);
+
+    pthread_t threads[PRODUCERS];
+    producer_arg args[PRODUCERS];
+    for (uint32_t i = 0; i < PRODUCERS; ++i) {
+        args[i] = { NULL, heap, i };
+        pthread_create(&threads[i], NULL, heap_producer, &args[i]);
+    }
+    for (uint32_t i = 0; i < PRODUCERS; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+    ASSERT_EQ(static_cast<size_t>(PRODUCERS * PCBS_PER_PRODUCER), concurrent_heap_size(heap));
+
+    ProcessControlBlock_t batch[100];
+    uint32_t last_burst = 0;
+    size_t received = 0;
+    size_t count;
+    while ((count = concurrent_heap_pop_batch(heap, batch, 100)) > 0) {
+        for (size_t i = 0; i < count; ++i) {
+            ASSERT_LE(last_burst, batch[i].remaining_burst_time);
+            last_burst = batch[i].remaining_burst_time;
+        }
+        received += count;
+    }
+    ASSERT_EQ(static_cast<size_t>(PRODUCERS * PCBS_PER_PRODUCER), received);
+    concurrent_heap_destroy(heap);
+}
+
+// online_scheduler TEST 1: Feeding the RR multicore example in one PCB at a time gives the same answer
+TEST(online_scheduler, IncrementalMatchesBatch) {
+    online_scheduler_t* scheduler = online_scheduler_create(POLICY_RR, 2);
+    ASSERT_NE(nullptr, scheduler);
+
+    ProcessControlBlock_t pcb1 = { .remaining_burst_time = 3, .priority = 0, .arrival = 0, .started = false };
+    ProcessControlBlock_t pcb2 = { .remaining_burst_time = 2, .priority = 0, .arrival = 0, .started = false };
+    uint64_t id1, id2;
+    ASSERT_TRUE(online_scheduler_submit(scheduler, &pcb1, &id1));
+    ASSERT_TRUE(online_scheduler_submit(scheduler, &pcb2, &id2));
+
+    // Nothing done after one quantum
+    ScheduleCompletion_t completions[4];
+    ASSERT_TRUE(online_scheduler_advance(scheduler, 3));
+    ASSERT_EQ(0u, online_scheduler_poll(scheduler, completions, 4));
+
+    // Second PCB finishes at 4, first at 5
+    ASSERT_TRUE(online_scheduler_advance(scheduler, 4));
+    ASSERT_EQ(1u, online_scheduler_poll(scheduler, completions, 4));
+    ASSERT_EQ(id2, completions[0].job_id);
+    ASSERT_EQ(4ul, completions[0].completion);
+    ASSERT_TRUE(online_scheduler_drain(scheduler));
+    ASSERT_EQ(1u, online_scheduler_poll(scheduler, completions, 4));
+    ASSERT_EQ(id1, completions[0].job_id);
+    ASSERT_EQ(5ul, completions[0].completion);
+
+    OnlineStats_t stats;
+    ASSERT_TRUE(online_scheduler_snapshot(scheduler, &stats));
+    ASSERT_FLOAT_EQ(1.0f, stats.schedule.average_waiting_time);
+    ASSERT_FLOAT_EQ(4.5f, stats.schedule.average_turnaround_time);
+    ASSERT_EQ(5ul, stats.busy_time);
+    ASSERT_EQ(2u, stats.completed);
+
+    online_scheduler_destroy(scheduler);
+}
+
+// A shorter PCB submitted mid-run preempts under SRTF, and arrivals in the past are refused
+TEST(online_scheduler, SubmitWhileRunning) {
+    online_scheduler_t* scheduler = online_scheduler_create(POLICY_SRTF, 0);
+    ASSERT_NE(nullptr, scheduler);
+
+    ProcessControlBlock_t long_pcb = { .remaining_burst_time = 8, .priority = 0, .arrival = 0, .started = false };
+    ASSERT_TRUE(online_scheduler_submit(scheduler, &long_pcb, NULL));
+    ASSERT_TRUE(online_scheduler_advance(scheduler, 1));
+
+    ProcessControlBlock_t late_pcb = { .remaining_burst_time = 2, .priority = 0, .arrival = 0, .started = false };
+    ASSERT_FALSE(online_scheduler_submit(scheduler, &late_pcb, NULL));
+    ProcessControlBlock_t short_pcb = { .remaining_burst_time = 2, .priority = 0, .arrival = 1, .started = false };
+    ASSERT_TRUE(online_scheduler_submit(scheduler, &short_pcb, NULL));
+
+    ASSERT_TRUE(online_scheduler_drain(scheduler));
+    OnlineStats_t stats;
+    ASSERT_TRUE(online_scheduler_snapshot(scheduler, &stats));
+    ASSERT_FLOAT_EQ(0.0f, stats.schedule.average_waiting_time);
+    ASSERT_FLOAT_EQ(6.0f, stats.schedule.average_turnaround_time);
+    ASSERT_EQ(10ul, stats.schedule.total_run_time);
+
+    online_scheduler_destroy(scheduler);
+}
+
+// Switch costs follow the batch rule, only the preemptive policies charge and count them
+TEST(online_scheduler, SwitchCostOnlyWhenPreemptive) {
+    set_context_switch_cost(5);
+    const SchedulePolicy_t policies[] = { POLICY_FCFS, POLICY_SJF, POLICY_PRIORITY, POLICY_SRTF };
+    for (SchedulePolicy_t policy : policies) {
+        online_scheduler_t* scheduler = online_scheduler_create(policy, 0);
+        ASSERT_NE(nullptr, scheduler);
+        ProcessControlBlock_t long_pcb = { .remaining_burst_time = 8, .priority = 0, .arrival = 0, .started = false };
+        ProcessControlBlock_t short_pcb = { .remaining_burst_time = 2, .priority = 0, .arrival = 1, .started = false };
+        ASSERT_TRUE(online_scheduler_submit(scheduler, &long_pcb, NULL));
+        ASSERT_TRUE(online_scheduler_submit(scheduler, &short_pcb, NULL));
+        ASSERT_TRUE(online_scheduler_drain(scheduler));
+
+        OnlineStats_t stats;
+        ASSERT_TRUE(online_scheduler_snapshot(scheduler, &stats));
+        if (policy == POLICY_SRTF) {
+            // preempted at 1, switched back at 8, 5 each way
+            ASSERT_EQ(20ul, stats.schedule.total_run_time);
+            ASSERT_EQ(2ul, stats.schedule.context_switches);
+            ASSERT_EQ(10ul, stats.schedule.switch_overhead);
+            ASSERT_EQ(20ul, stats.busy_time);
+        } else {
+            ASSERT_EQ(10ul, stats.schedule.total_run_time);
+            ASSERT_EQ(0ul, stats.schedule.context_switches);
+            ASSERT_EQ(0ul, stats.schedule.switch_overhead);
+            ASSERT_EQ(10ul, stats.busy_time);
+        }
+        online_scheduler_destroy(scheduler);
+    }
+    set_context_switch_cost(0);
+}
+
+// multilevel_feedback_queue TEST 1: Ensure the function returns false on NULL input or a bad config
+TEST(multilevel_feedback_queue, InvalidConfig) {
+    dyn_array_t* ready_queue = dyn_array_create(1, sizeof(ProcessControlBlock_t), NULL);
+    ProcessControlBlock_t pcb1 = { .remaining_burst_time = 5, .priority = 0, .arrival = 0, .started = false };
+    dyn_array_push_back(ready_queue, &pcb1);
+
+    MlfqConfig_t config;
+    memset(&config, 0, sizeof(config));
+    ScheduleResult_t result;
+    ASSERT_EQ(false, multilevel_feedback_queue(ready_queue, &result, &config)); // no levels
+    config.levels = 2;
+    config.quanta[0] = 2;
+    ASSERT_EQ(false, multilevel_feedback_queue(ready_queue, &result, &config)); // level 1 has no quantum
+    ASSERT_EQ(false, multilevel_feedback_queue(NULL, &result, &config));
+
+    dyn_array_destroy(ready_queue);
+}
+
+// PCBs that burn their whole slice drop a level, and an arrival at level 0 preempts a demoted PCB
+TEST(multilevel_feedback_queue, DemotionAndPreemption) {
+    MlfqConfig_t config;
+    memset(&config, 0, sizeof(config));
+    config.levels = 3;
+    config.quanta[0] = 2;
+    config.quanta[1] = 4;
+    config.quanta[2] = 8;
+
+    dyn_array_t* ready_queue = dyn_array_create(2, sizeof(ProcessControlBlock_t), NULL);
+    ProcessControlBlock_t pcb1 = { .remaining_burst_time = 5, .priority = 0, .arrival = 0, .started = false };
+    ProcessControlBlock_t pcb2 = { .remaining_burst_time = 3, .priority = 0, .arrival = 1, .started = false };
+    dyn_array_push_back(ready_queue, &pcb1);
+    dyn_array_push_back(ready_queue, &pcb2);
+
+    // A 0-2 (demoted), B 2-4 (demoted), A 4-7, B 7-8
+    ScheduleResult_t result;
+    ASSERT_TRUE(multilevel_feedback_queue(ready_queue, &result, &config));
+    ASSERT_FLOAT_EQ(0.5f, result.average_waiting_time);
+    ASSERT_FLOAT_EQ(7.0f, result.average_turnaround_time);
+    ASSERT_EQ(8ul, result.total_run_time);
+    dyn_array_destroy(ready_queue);
+
+    config.levels = 2;
+    ready_queue = dyn_array_create(2, sizeof(ProcessControlBlock_t), NULL);
+    ProcessControlBlock_t pcb3 = { .remaining_burst_time = 10, .priority = 0, .arrival = 0, .started = false };
+    ProcessControlBlock_t pcb4 = { .remaining_burst_time = 1, .priority = 0, .arrival = 3, .started = false };
+    dyn_array_push_back(ready_queue, &pcb3);
+    dyn_array_push_back(ready_queue, &pcb4);
+
+    // A 0-3, preempted by B 3-4, A 4-11
+    ASSERT_TRUE(multilevel_feedback_queue(ready_queue, &result, &config));
+    ASSERT_FLOAT_EQ(0.0f, result.average_waiting_time);
+    ASSERT_FLOAT_EQ(6.0f, result.average_turnaround_time);
+    ASSERT_EQ(11ul, result.total_run_time);
+    dyn_array_destroy(ready_queue);
+}
+
+TEST(round_robin, ArrivalsQueueAheadOfPreempted) {
+    dyn_array_t* ready_queue = dyn_array_create(2, sizeof(ProcessControlBlock_t), NULL);
+    ProcessControlBlock_t pcb1 = { .remaining_burst_time = 5, .priority = 0, .arrival = 0, .started = false };
+    ProcessControlBlock_t pcb2 = { .remaining_burst_time = 3, .priority = 0, .arrival = 1, .started = false };
+    dyn_array_push_back(ready_queue, &pcb1);
+    dyn_array_push_back(ready_queue, &pcb2);
+
+    ScheduleResult_t result;
+    ASSERT_FALSE(round_robin(ready_queue, &result, 0));
+    // A 0-2, B 2-4, A 4-6, B 6-7, A 7-8
+    ASSERT_TRUE(round_robin(ready_queue, &result, 2));
+    ASSERT_FLOAT_EQ(0.5f, result.average_waiting_time);
+    ASSERT_FLOAT_EQ(7.0f, result.average_turnaround_time);
+    ASSERT_EQ(8ul, result.total_run_time);
+    dyn_array_destroy(ready_queue);
+}
+
+// Equal weights split the target latency evenly, so two PCBs alternate one tick at a time
+TEST(completely_fair_scheduler, EqualWeightsAlternate) {
+    dyn_array_t* ready_queue = dyn_array_create(2, sizeof(ProcessControlBlock_t), NULL);
+    ProcessControlBlock_t pcb1 = { .remaining_burst_time = 4, .priority = 20, .arrival = 0, .started = false };
+    ProcessControlBlock_t pcb2 = { .remaining_burst_time = 4, .priority = 20, .arrival = 0, .started = false };
+    dyn_array_push_back(ready_queue, &pcb1);
+    dyn_array_push_back(ready_queue, &pcb2);
+
+    ScheduleResult_t result;
+    ASSERT_FALSE(completely_fair_scheduler(ready_queue, &result, 0));
+    ASSERT_TRUE(completely_fair_scheduler(ready_queue, &result, 2));
+    ASSERT_FLOAT_EQ(0.5f, result.average_waiting_time);
+    ASSERT_FLOAT_EQ(7.5f, result.average_turnaround_time);
+    ASSERT_EQ(8ul, result.total_run_time);
+    dyn_array_destroy(ready_queue);
+}
+
+// The heavier (lower priority value) PCB gets nearly all of each period
+TEST(completely_fair_scheduler, WeightsFromPriority) {
+    dyn_array_t* ready_queue = dyn_array_create(2, sizeof(ProcessControlBlock_t), NULL);
+    ProcessControlBlock_t pcb1 = { .remaining_burst_time = 10, .priority = 15, .arrival = 0, .started = false };
+    ProcessControlBlock_t pcb2 = { .remaining_burst_time = 10, .priority = 25, .arrival = 0, .started = false };
+    dyn_array_push_back(ready_queue, &pcb1);
+    dyn_array_push_back(ready_queue, &pcb2);
+
+    // A 0-9, B 9-10, A 10-11, B 11-20
+    ScheduleResult_t result;
+    ASSERT_TRUE(completely_fair_scheduler(ready_queue, &result, 10));
+    ASSERT_FLOAT_EQ(4.5f, result.average_waiting_time);
+    ASSERT_FLOAT_EQ(15.5f, result.average_turnaround_time);
+    ASSERT_EQ(20ul, result.total_run_time);
+    dyn_array_destroy(ready_queue);
+}
+
+// An arrival with an earlier deadline preempts, the preempted PCB misses its deadline
+TEST(earliest_deadline_first, PreemptsAndCountsMisses) {
+    dyn_array_t* ready_queue = dyn_array_create(3, sizeof(ProcessControlBlock_t), NULL);
+    dyn_array_t* deadlines = dyn_array_create(3, sizeof(uint32_t), NULL);
+    ProcessControlBlock_t pcb1 = { .remaining_burst_time = 6, .priority = 0, .arrival = 0, .started = false };
+    ProcessControlBlock_t pcb2 = { .remaining_burst_time = 2, .priority = 0, .arrival = 2, .started = false };
+    ProcessControlBlock_t pcb3 = { .remaining_burst_time = 3, .priority = 0, .arrival = 3, .started = false };
+    uint32_t deadline1 = 8, deadline2 = 5, deadline3 = EDF_NO_DEADLINE;
+    dyn_array_push_back(ready_queue, &pcb1);
+    dyn_array_push_back(ready_queue, &pcb2);
+    dyn_array_push_back(ready_queue, &pcb3);
+    dyn_array_push_back(deadlines, &deadline1);
+    dyn_array_push_back(deadlines, &deadline2);
+
+    DeadlineResult_t result;
+    // deadlines must line up with the PCBs
+    ASSERT_FALSE(earliest_deadline_first(ready_queue, deadlines, &result));
+    dyn_array_push_back(deadlines, &deadline3);
+
+    // A 0-2, B 2-4, A 4-8, C 8-11
+    ASSERT_TRUE(earliest_deadline_first(ready_queue, deadlines, &result));
+    ASSERT_EQ(2u, result.deadline_count);
+    ASSERT_EQ(0u, result.deadline_misses);
+    ASSERT_FLOAT_EQ(5.0f / 3, result.schedule.average_waiting_time);
+    ASSERT_FLOAT_EQ(6.0f, result.schedule.average_turnaround_time);
+    ASSERT_EQ(11ul, result.schedule.total_run_time);
+    dyn_array_destroy(ready_queue);
+
+    // Same PCBs with a tighter deadline on A: B still preempts, and A and C both finish 2 late
+    ready_queue = dyn_array_create(3, sizeof(ProcessControlBlock_t), NULL);
+    dyn_array_push_back(ready_queue, &pcb1);
+    dyn_array_push_back(ready_queue, &pcb2);
+    dyn_array_push_back(ready_queue, &pcb3);
+    *(uint32_t *) dyn_array_at(deadlines, 0) = 6;
+    *(uint32_t *) dyn_array_at(deadlines, 2) = 9;
+    ASSERT_TRUE(earliest_deadline_first(ready_queue, deadlines, &result));
+    ASSERT_EQ(3u, result.deadline_count);
+    ASSERT_EQ(2u, result.deadline_misses);
+    ASSERT_DOUBLE_EQ(4.0, result.total_lateness);
+    ASSERT_EQ(2ul, result.tardiness_p50);
+    ASSERT_EQ(2ul, result.tardiness_max);
+    dyn_array_destroy(ready_queue);
+    dyn_array_destroy(deadlines);
+}
+
+// Three times the tickets gets three times the CPU, so both PCBs finish together at the end
+TEST(stride_scheduling, SharesFollowTickets) {
+    dyn_array_t* ready_queue = dyn_array_create(2, sizeof(ProcessControlBlock_t), NULL);
+    ProcessControlBlock_t pcb1 = { .remaining_burst_time = 40, .priority = 1, .arrival = 0, .started = false };
+    ProcessControlBlock_t pcb2 = { .remaining_burst_time = 120, .priority = 3, .arrival = 0, .started = false };
+    dyn_array_push_back(ready_queue, &pcb1);
+    dyn_array_push_back(ready_queue, &pcb2);
+
+    ShareResult_t result;
+    ASSERT_FALSE(stride_scheduling(ready_queue, &result, 0));
+    ASSERT_TRUE(stride_scheduling(ready_queue, &result, 1));
+    ASSERT_EQ(160ul, result.schedule.total_run_time);
+    ASSERT_FLOAT_EQ(0.5f, result.schedule.average_waiting_time);
+    ASSERT_NEAR(1.0, result.median_share_ratio, 0.05);
+    ASSERT_NEAR(1.0, result.min_share_ratio, 0.1);
+    ASSERT_LE(result.mean_absolute_lag, 1.0);
+    dyn_array_destroy(ready_queue);
+}
+
+// Draws are reproducible for a seed and come out close to the ticket ratio over many quanta
+TEST(lottery_scheduling, SeededDrawsApproachShares) {
+    ProcessControlBlock_t pcb1 = { .remaining_burst_time = 1000, .priority = 1, .arrival = 0, .started = false };
+    ProcessControlBlock_t pcb2 = { .remaining_burst_time = 3000, .priority = 3, .arrival = 0, .started = false };
+    ShareResult_t first;
+    ShareResult_t second;
+    for (ShareResult_t* result : { &first, &second }) {
+        dyn_array_t* ready_queue = dyn_array_create(2, sizeof(ProcessControlBlock_t), NULL);
+        dyn_array_push_back(ready_queue, &pcb1);
+        dyn_array_push_back(ready_queue, &pcb2);
+        ASSERT_TRUE(lottery_scheduling(ready_queue, result, 1, 42));
+        dyn_array_destroy(ready_queue);
+    }
+
+    ASSERT_EQ(4000ul, first.schedule.total_run_time);
+    ASSERT_FLOAT_EQ(first.schedule.average_turnaround_time, second.schedule.average_turnaround_time);
+    ASSERT_DOUBLE_EQ(first.median_share_ratio, second.median_share_ratio);
+    ASSERT_NEAR(1.0, first.median_share_ratio, 0.1);
+}
+
+// A zero burst PCB has no share to measure, it mustn't turn the ratios into NaN for stride or lottery
+TEST(share_scheduling, ZeroBurstHasNoRatio) {
+    ProcessControlBlock_t pcbs[] = { {0, 1, 0, false}, {5, 1, 0, false}, {3, 2, 1, false} };
+    for (int lottery = 0; lottery < 2; ++lottery) {
+        dyn_array_t* ready_queue = dyn_array_create(3, sizeof(ProcessControlBlock_t), NULL);
+        dyn_array_append(ready_queue, pcbs, 3);
+        ShareResult_t result;
+        ASSERT_TRUE(lottery ? lottery_scheduling(ready_queue, &result, 2, 7) : stride_scheduling(ready_queue, &result, 2));
+        ASSERT_TRUE(std::isfinite(result.median_share_ratio));
+        ASSERT_TRUE(std::isfinite(result.min_share_ratio));
+        ASSERT_TRUE(std::isfinite(result.max_share_ratio));
+        ASSERT_GT(result.min_share_ratio, 0.0);
+        ASSERT_LE(result.min_share_ratio, result.median_share_ratio);
+        ASSERT_LE(result.median_share_ratio, result.max_share_ratio);
+        ASSERT_EQ(8ul, result.schedule.total_run_time);
+
+        // Nothing but zero bursts, nobody was shortchanged
+        dyn_array_clear(ready_queue);
+        dyn_array_push_back(ready_queue, &pcbs[0]);
+        dyn_array_push_back(ready_queue, &pcbs[0]);
+        ASSERT_TRUE(lottery ? lottery_scheduling(ready_queue, &result, 2, 7) : stride_scheduling(ready_queue, &result, 2));
+        ASSERT_DOUBLE_EQ(1.0, result.median_share_ratio);
+        ASSERT_DOUBLE_EQ(1.0, result.min_share_ratio);
+        ASSERT_DOUBLE_EQ(1.0, result.max_share_ratio);
+        dyn_array_destroy(ready_queue);
+    }
+}
+
+// Every hand-off to a different PCB costs the switch time, a PCB keeping the CPU costs nothing
+TEST(round_robin, ContextSwitchCost) {
+    dyn_array_t* ready_queue = dyn_array_create(2, sizeof(ProcessControlBlock_t), NULL);
+    ProcessControlBlock_t pcb1 = { .remaining_burst_time = 5, .priority = 0, .arrival = 0, .started = false };
+    ProcessControlBlock_t pcb2 = { .remaining_burst_time = 3, .priority = 0, .arrival = 1, .started = false };
+    dyn_array_push_back(ready_queue, &pcb1);
+    dyn_array_push_back(ready_queue, &pcb2);
+
+    // A 0-2, switch, B 3-5, switch, A 6-8, switch, B 9-10, switch, A 11-12
+    set_context_switch_cost(1);
+    ScheduleResult_t result;
+    bool success = round_robin(ready_queue, &result, 2);
+    set_context_switch_cost(0);
+    ASSERT_TRUE(success);
+    ASSERT_EQ(4ul, result.context_switches);
+    ASSERT_EQ(4ul, result.switch_overhead);
+    ASSERT_FLOAT_EQ(0.5f, result.average_waiting_time);
+    ASSERT_FLOAT_EQ(10.5f, result.average_turnaround_time);
+    ASSERT_EQ(12ul, result.total_run_time);
+    dyn_array_destroy(ready_queue);
+}
+
+// I/O overlaps with the other PCB's CPU burst, and the trace round trips through the loader
+TEST(multi_burst_schedule, IoOverlapsCpu) {
+    const uint32_t trace[] = { 0, 0, 3, 2, 5, 2,    // A: arrives at 0, CPU 2, I/O 5, CPU 2
+                               0, 0, 1, 3 };        // B: arrives at 0, CPU 3
+    const char *file_name = "multi_burst.bin";
+    FILE *file = fopen(file_name, "wb");
+    ASSERT_NE(nullptr, file);
+    fwrite(trace, sizeof(trace), 1, file);
+    fclose(file);
+
+    BurstPool_t *pool = NULL;
+    dyn_array_t* ready_queue = load_multi_burst_trace(file_name, &pool);
+    remove(file_name);
+    ASSERT_NE(nullptr, ready_queue);
+    ASSERT_EQ(2u, burst_pool_size(pool));
+
+    // A 0-2, B 2-5, idle while A's I/O finishes, A 7-9
+    MultiBurstResult_t result;
+    ASSERT_TRUE(multi_burst_schedule(ready_queue, pool, 0, &result));
+    ASSERT_FLOAT_EQ(1.0f, result.schedule.average_waiting_time);
+    ASSERT_FLOAT_EQ(7.0f, result.schedule.average_turnaround_time);
+    ASSERT_EQ(9ul, result.schedule.total_run_time);
+    ASSERT_EQ(3ul, result.cpu_bursts);
+    ASSERT_EQ(1ul, result.io_bursts);
+    ASSERT_EQ(7ul, result.cpu_busy_time);
+    ASSERT_EQ(5ul, result.io_time);
+    ASSERT_FLOAT_EQ(7.0f / 9, result.cpu_utilization);
+
+    // an I/O burst can't come last
+    const uint32_t bad[] = { 1, 1 };
+    ASSERT_FALSE(burst_pool_append(pool, bad, 2));
+    dyn_array_destroy(ready_queue);
+    burst_pool_destroy(pool);
+}
+
+TEST(timer_wheel, PopsInExpiryOrder) {
+    timer_wheel_t *wheel = timer_wheel_create(10, 0);
+    ASSERT_NE(nullptr, wheel);
+    ASSERT_FALSE(timer_wheel_insert(wheel, 9, 0, NULL));
+
+    // far enough apart to land on different levels, plus a tie that has to stay FIFO
+    uint64_t cancelled;
+    ASSERT_TRUE(timer_wheel_insert(wheel, 100000, 1, NULL));
+    ASSERT_TRUE(timer_wheel_insert(wheel, 70, 2, NULL));
+    ASSERT_TRUE(timer_wheel_insert(wheel, 5000, 3, &cancelled));
+    ASSERT_TRUE(timer_wheel_insert(wheel, 70, 4, NULL));
+    ASSERT_TRUE(timer_wheel_insert(wheel, 10, 5, NULL));
+    ASSERT_TRUE(timer_wheel_cancel(wheel, cancelled));
+    ASSERT_FALSE(timer_wheel_cancel(wheel, cancelled));
+    ASSERT_EQ(4u, timer_wheel_size(wheel));
+
+    uint64_t expiry, value;
+    ASSERT_TRUE(timer_wheel_peek(wheel, &expiry));
+    ASSERT_EQ(10u, expiry);
+    ASSERT_TRUE(timer_wheel_pop(wheel, 10, &expiry, &value));
+    ASSERT_EQ(5u, value);
+
+    // nothing due by 60, and the clock mustn't run past it
+    ASSERT_FALSE(timer_wheel_pop(wheel, 60, &expiry, &value));
+    ASSERT_LE(timer_wheel_now(wheel), 60u);
+    ASSERT_TRUE(timer_wheel_insert(wheel, 60, 6, NULL));
+
+    const uint64_t expected_expiry[] = { 60, 70, 70, 100000 };
+    const uint64_t expected_value[] = { 6, 2, 4, 1 };
+    for (size_t i = 0; i < 4; ++i) {
+        ASSERT_TRUE(timer_wheel_pop(wheel, UINT64_MAX, &expiry, &value));
+        ASSERT_EQ(expected_expiry[i], expiry);
+        ASSERT_EQ(expected_value[i], value);
+    }
+    ASSERT_FALSE(timer_wheel_pop(wheel, UINT64_MAX, &expiry, &value));
+    ASSERT_EQ(0u, timer_wheel_size(wheel));
+    timer_wheel_destroy(wheel);
+}
+
+TEST(load_process_control_blocks, RefillReusesQueue) {
+    const char *file_name = "pcb_refill.bin";
+    ProcessControlBlock_t pcbs[300];
+    for (uint32_t i = 0; i < 300; ++i) {
+        pcbs[i] = { .remaining_burst_time = i + 1, .priority = 0, .arrival = i, .started = true };
+    }
+    FILE *file = fopen(file_name, "wb");
+    ASSERT_NE(nullptr, file);
+    fwrite(pcbs, sizeof(ProcessControlBlock_t), 300, file);
+    fclose(file);
+
+    // starts with leftovers from a previous trace, which have to go
+    dyn_array_t *ready_queue = dyn_array_create(0, sizeof(ProcessControlBlock_t), NULL);
+    ASSERT_TRUE(dyn_array_push_back(ready_queue, &pcbs[0]));
+    ASSERT_TRUE(load_process_control_blocks_into(file_name, ready_queue));
+    ASSERT_EQ(300u, dyn_array_size(ready_queue));
+    ProcessControlBlock_t *loaded = (ProcessControlBlock_t *) dyn_array_at(ready_queue, 299);
+    ASSERT_EQ(300u, loaded->remaining_burst_time);
+    ASSERT_FALSE(loaded->started);
+
+    // a second load of the same size shouldn't need more room
+    const size_t capacity = dyn_array_capacity(ready_queue);
+    ASSERT_TRUE(load_process_control_blocks_into(file_name, ready_queue));
+    ASSERT_EQ(300u, dyn_array_size(ready_queue));
+    ASSERT_EQ(capacity, dyn_array_capacity(ready_queue));
+    remove(file_name);
+
+    ASSERT_FALSE(load_process_control_blocks_into(file_name, ready_queue));
+    ASSERT_TRUE(dyn_array_empty(ready_queue));
+    dyn_array_destroy(ready_queue);
+}
+
+TEST(instrumentation, ScopesAddUpPerPhase) {
+    instrument_reset();
+    for (int i = 0; i < 3; ++i) {
+        instrument_scope_t scope = instrument_begin(INSTRUMENT_SORT);
+        instrument_end(&scope);
+    }
+
+    instrument_stats_t stats;
+    ASSERT_TRUE(instrument_snapshot(INSTRUMENT_SORT, &stats));
+    ASSERT_EQ(3u, stats.calls);
+    ASSERT_TRUE(instrument_snapshot(INSTRUMENT_LOAD, &stats));
+    ASSERT_EQ(0u, stats.calls);
+    ASSERT_FALSE(instrument_snapshot(INSTRUMENT_PHASE_COUNT, &stats));
+    ASSERT_STREQ("schedule", instrument_phase_name(INSTRUMENT_SCHEDULE));
+    ASSERT_EQ(nullptr, instrument_counter_name(INSTRUMENT_COUNTER_COUNT));
+
+    instrument_reset();
+    ASSERT_TRUE(instrument_snapshot(INSTRUMENT_SORT, &stats));
+    ASSERT_EQ(0u, stats.calls);
+}
+
+TEST(dyn_array_stats, CountsMovesAndReallocs) {
+    dyn_array_t *array = dyn_array_create(0, sizeof(uint32_t), NULL);
+    ASSERT_NE(nullptr, array);
+    for (uint32_t i = 0; i < 40; ++i) {
+        ASSERT_TRUE(dyn_array_push_front(array, &i));
+    }
+    ASSERT_TRUE(dyn_array_pop_back(array));
+
+    dyn_array_stats_t stats;
+    if (!DYN_ARRAY_STATS_ENABLED) {
+        ASSERT_FALSE(dyn_array_get_stats(array, &stats));
+        dyn_array_destroy(array);
+        return;
+    }
+    ASSERT_TRUE(dyn_array_get_stats(array, &stats));
+    ASSERT_EQ(40u, stats.ops[DYN_OP_PUSH_FRONT]);
+    ASSERT_EQ(1u, stats.ops[DYN_OP_POP_BACK]);
+    // 16 -> 32 -> 64, and every push_front moves everything already there
+    ASSERT_EQ(2u, stats.reallocs);
+    ASSERT_EQ(64u, stats.peak_capacity);
+    ASSERT_EQ(40u, stats.peak_size);
+    ASSERT_EQ(sizeof(uint32_t) * 39 * 40 / 2, stats.bytes_moved);
+
+    dyn_array_reset_stats(array);
+    ASSERT_TRUE(dyn_array_get_stats(array, &stats));
+    ASSERT_EQ(0u, stats.bytes_moved);
+    ASSERT_EQ(39u, stats.peak_size);
+    ASSERT_STREQ("push_front", dyn_array_op_name(DYN_OP_PUSH_FRONT));
+    dyn_array_destroy(array);
+}
+
+TEST(dyn_array_range, InsertEraseExtractSplice) {
+    const uint32_t values[] = { 1, 2, 3, 4, 5, 6 };
+    dyn_array_t *array = dyn_array_create(0, sizeof(uint32_t), NULL);
+    dyn_array_t *other = dyn_array_create(0, sizeof(uint32_t), NULL);
+    ASSERT_TRUE(dyn_array_append(array, values, 2));                // 1 2
+    ASSERT_TRUE(dyn_array_append(array, values + 4, 2));            // 1 2 5 6
+    ASSERT_TRUE(dyn_array_insert_range(array, 2, values + 2, 2));   // 1 2 3 4 5 6
+    ASSERT_FALSE(dyn_array_insert_range(array, 7, values, 1));
+    ASSERT_FALSE(dyn_array_append(array, values, 0));
+    ASSERT_EQ(0, memcmp(values, dyn_array_front(array), sizeof(values)));
+
+    uint32_t extracted[2];
+    ASSERT_FALSE(dyn_array_extract_range(array, 5, 2, extracted));
+    ASSERT_TRUE(dyn_array_extract_range(array, 1, 2, extracted));   // 1 4 5 6
+    ASSERT_EQ(2u, extracted[0]);
+    ASSERT_EQ(3u, extracted[1]);
+    ASSERT_TRUE(dyn_array_erase_range(array, 3, 1));                // 1 4 5
+
+    // move 4 5 over in front of the 9
+    const uint32_t nine = 9;
+    ASSERT_TRUE(dyn_array_push_back(other, &nine));
+    ASSERT_FALSE(dyn_array_splice(other, 0, array, 2, 2));
+    ASSERT_FALSE(dyn_array_splice(array, 0, array, 0, 1));
+    ASSERT_TRUE(dyn_array_splice(other, 0, array, 1, 2));
+    ASSERT_EQ(1u, dyn_array_size(array));
+    const uint32_t expected[] = { 4, 5, 9 };
+    ASSERT_EQ(3u, dyn_array_size(other));
+    ASSERT_EQ(0, memcmp(expected, dyn_array_front(other), sizeof(expected)));
+
+    dyn_array_destroy(array);
+    dyn_array_destroy(other);
+}
+
+static unsigned destructed_total = 0;
+
+static void count_destructed(void *object) {
+    destructed_total += *(uint32_t *) object;
+}
+
+static bool burst_done(const void *const object, void *) {
+    return ((const ProcessControlBlock_t *) object)->remaining_burst_time == 0;
+}
+
+TEST(dyn_array_unordered, SwapEraseAndRemoveIf) {
+    const uint32_t values[] = { 1, 2, 3, 4 };
+    dyn_array_t *array = dyn_array_import(values, 4, sizeof(uint32_t), count_destructed);
+    ASSERT_NE(nullptr, array);
+    destructed_total = 0;
+    ASSERT_TRUE(dyn_array_swap_erase(array, 0));        // 4 2 3
+    ASSERT_EQ(1u, destructed_total);
+    uint32_t value;
+    ASSERT_TRUE(dyn_array_swap_extract(array, 2, &value));  // the last one, nothing to move: 4 2
+    ASSERT_EQ(3u, value);
+    ASSERT_EQ(1u, destructed_total);
+    ASSERT_FALSE(dyn_array_swap_erase(array, 2));
+    ASSERT_EQ(4u, *(uint32_t *) dyn_array_at(array, 0));
+    ASSERT_EQ(2u, dyn_array_size(array));
+    destructed_total = 0;
+    dyn_array_destroy(array);
+    ASSERT_EQ(6u, destructed_total);
+
+    // finished PCBs go, the rest stay in order
+    const uint32_t bursts[] = { 0, 5, 0, 0, 7, 8, 0 };
+    dyn_array_t *queue = dyn_array_create(0, sizeof(ProcessControlBlock_t), NULL);
+    for (uint32_t i = 0; i < 7; ++i) {
+        ProcessControlBlock_t pcb = { .remaining_burst_time = bursts[i], .priority = 0, .arrival = i, .started = true };
+        ASSERT_TRUE(dyn_array_push_back(queue, &pcb));
+    }
+    ASSERT_EQ(4u, dyn_array_remove_if(queue, burst_done, NULL));
+    ASSERT_EQ(3u, dyn_array_size(queue));
+    const uint32_t survivors[] = { 1, 4, 5 };
+    for (size_t i = 0; i < 3; ++i) {
+        ASSERT_EQ(survivors[i], ((ProcessControlBlock_t *) dyn_array_at(queue, i))->arrival);
+    }
+    ASSERT_EQ(0u, dyn_array_remove_if(queue, burst_done, NULL));
+    ASSERT_EQ(0u, dyn_array_remove_if(queue, NULL, NULL));
+    dyn_array_destroy(queue);
+}
+
+static int compare_pcb_priority(const void *a, const void *b) {
+    const uint32_t priority_a = ((const ProcessControlBlock_t *) a)->priority;
+    const uint32_t priority_b = ((const ProcessControlBlock_t *) b)->priority;
+    return (priority_a > priority_b) - (priority_a < priority_b);
+}
+
+TEST(dyn_array_sorted, BoundsInsertAndMerge) {
+    // priorities 1 2 2 4, tagged with their position through arrival
+    dyn_array_t *queue = dyn_array_create(0, sizeof(ProcessControlBlock_t), NULL);
+    const uint32_t priorities[] = { 1, 2, 2, 4 };
+    for (uint32_t i = 0; i < 4; ++i) {
+        ProcessControlBlock_t pcb = { .remaining_burst_time = 1, .priority = priorities[i], .arrival = i, .started = false };
+        ASSERT_TRUE(dyn_array_push_back(queue, &pcb));
+    }
+    ProcessControlBlock_t probe = { .remaining_burst_time = 1, .priority = 2, .arrival = 10, .started = false };
+    ASSERT_EQ(1u, dyn_array_lower_bound(queue, &probe, compare_pcb_priority));
+    ASSERT_EQ(3u, dyn_array_upper_bound(queue, &probe, compare_pcb_priority));
+    probe.priority = 5;
+    ASSERT_EQ(4u, dyn_array_lower_bound(queue, &probe, compare_pcb_priority));
+    ASSERT_EQ(0u, dyn_array_lower_bound(NULL, &probe, compare_pcb_priority));
+
+    // insert_sorted still goes ahead of equal keys
+    probe.priority = 2;
+    ASSERT_TRUE(dyn_array_insert_sorted(queue, &probe, compare_pcb_priority));
+    ASSERT_EQ(10u, ((ProcessControlBlock_t *) dyn_array_at(queue, 1))->arrival);
+
+    // batch 0 2 3 9 merges in behind equal keys: 0 1 2(10) 2 2 2(b) 3 4 9
+    ProcessControlBlock_t batch[4];
+    const uint32_t batch_priorities[] = { 0, 2, 3, 9 };
+    for (uint32_t i = 0; i < 4; ++i) {
+        batch[i] = { .remaining_burst_time = 1, .priority = batch_priorities[i], .arrival = 20 + i, .started = false };
+    }
+    ASSERT_TRUE(dyn_array_merge_sorted(queue, batch, 4, compare_pcb_priority));
+    ASSERT_EQ(9u, dyn_array_size(queue));
+    const uint32_t merged[] = { 20, 0, 10, 1, 2, 21, 22, 3, 23 };
+    for (size_t i = 0; i < 9; ++i) {
+        ASSERT_EQ(merged[i], ((ProcessControlBlock_t *) dyn_array_at(queue, i))->arrival);
+    }
+    ASSERT_FALSE(dyn_array_merge_sorted(queue, batch, 0, compare_pcb_priority));
+    ASSERT_FALSE(dyn_array_merge_sorted(queue, batch, 4, NULL));
+    dyn_array_destroy(queue);
+}
+
+// Non-preemptive, lowest priority value first, earliest arrival among equals
+TEST(priority, LowestValueFirst) {
+    dyn_array_t *ready_queue = dyn_array_create(4, sizeof(ProcessControlBlock_t), NULL);
+    const ProcessControlBlock_t pcbs[] = {
+        { .remaining_burst_time = 4, .priority = 3, .arrival = 0, .started = false },
+        { .remaining_burst_time = 2, .priority = 1, .arrival = 1, .started = false },
+        { .remaining_burst_time = 3, .priority = 2, .arrival = 1, .started = false },
+        { .remaining_burst_time = 1, .priority = 1, .arrival = 2, .started = false },
+    };
+    for (size_t i = 0; i < 4; ++i) {
+        ASSERT_TRUE(dyn_array_push_back(ready_queue, &pcbs[i]));
+    }
+    ScheduleResult_t result;
+    // runs 0, 1, 3, 2: waits 0 3 6 4, turnarounds 4 5 9 5
+    ASSERT_TRUE(priority(ready_queue, &result));
+    ASSERT_FLOAT_EQ(3.25f, result.average_waiting_time);
+    ASSERT_FLOAT_EQ(5.75f, result.average_turnaround_time);
+    ASSERT_EQ(10ul, result.total_run_time);
+    ASSERT_EQ(0u, ((ProcessControlBlock_t *) dyn_array_at(ready_queue, 2))->remaining_burst_time);
+    ASSERT_FALSE(priority(NULL, &result));
+    dyn_array_destroy(ready_queue);
+}
+
+// The non-preemptive schedulers only change PCBs when one finishes, none of them charges the switch cost
+TEST(priority, NonPreemptiveChargeNoSwitchCost) {
+    ProcessControlBlock_t pcbs[] = { {2, 3, 0, false}, {3, 2, 0, false}, {4, 1, 0, false} };
+    bool (*const schedulers[])(dyn_array_t *, ScheduleResult_t *) = { first_come_first_serve, shortest_job_first, priority };
+    set_context_switch_cost(5);
+    for (auto scheduler : schedulers) {
+        dyn_array_t* ready_queue = dyn_array_create(3, sizeof(ProcessControlBlock_t), NULL);
+        dyn_array_append(ready_queue, pcbs, 3);
+        ScheduleResult_t result;
+        ASSERT_TRUE(scheduler(ready_queue, &result));
+        ASSERT_EQ(9ul, result.total_run_time);
+        ASSERT_EQ(0ul, result.context_switches);
+        ASSERT_EQ(0ul, result.switch_overhead);
+        dyn_array_destroy(ready_queue);
+    }
+    set_context_switch_cost(0);
+}
+
+static int compare_pcb_burst(const void *a, const void *b) {
+    const uint32_t burst_a = ((const ProcessControlBlock_t *) a)->remaining_burst_time;
+    const uint32_t burst_b = ((const ProcessControlBlock_t *) b)->remaining_burst_time;
+    return (burst_a > burst_b) - (burst_a < burst_b);
+}
+
+// Odd thread count so the last run merges with nothing in one round, and LargeFile-style repeated keys
+TEST(dyn_array_sort_parallel, SortsLikeSerial) {
+    const size_t count = 300001;
+    dyn_array_t *queue = dyn_array_create(count, sizeof(ProcessControlBlock_t), NULL);
+    uint64_t arrival_sum = 0;
+    for (size_t i = 0; i < count; ++i) {
+        ProcessControlBlock_t pcb = { .remaining_burst_time = (uint32_t) ((i * 7919) % 10), .priority = 0,
+                                      .arrival = (uint32_t) i, .started = false };
+        ASSERT_TRUE(dyn_array_push_back(queue, &pcb));
+        arrival_sum += i;
+    }
+    ASSERT_TRUE(dyn_array_sort_parallel(queue, compare_pcb_burst, 5));
+    ASSERT_EQ(count, dyn_array_size(queue));
+    uint64_t sorted_sum = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const ProcessControlBlock_t *pcb = (const ProcessControlBlock_t *) dyn_array_at(queue, i);
+        sorted_sum += pcb->arrival;
+        if (i) {
+            ASSERT_LE(((const ProcessControlBlock_t *) dyn_array_at(queue, i - 1))->remaining_burst_time,
+                      pcb->remaining_burst_time);
+        }
+    }
+    ASSERT_EQ(arrival_sum, sorted_sum);
+    ASSERT_FALSE(dyn_array_sort_parallel(queue, NULL, 4));
+    ASSERT_FALSE(dyn_array_sort_parallel(NULL, compare_pcb_burst, 4));
+    dyn_array_destroy(queue);
+}
+
+// Grows from malloc'd storage onto 2MB aligned storage without losing anything
+TEST(dyn_array_allocation, HugePagesAndFirstTouch) {
+    dyn_array_t *queue = dyn_array_create_with(0, sizeof(ProcessControlBlock_t), NULL,
+                                               DYN_ALLOC_HUGE_PAGES | DYN_ALLOC_FIRST_TOUCH);
+    ASSERT_NE(nullptr, queue);
+    ASSERT_EQ((unsigned int) (DYN_ALLOC_HUGE_PAGES | DYN_ALLOC_FIRST_TOUCH), queue->allocation);
+    const size_t count = 300000;
+    for (size_t i = 0; i < count; ++i) {
+        ProcessControlBlock_t pcb = { .remaining_burst_time = (uint32_t) (count - i), .priority = 0,
+                                      .arrival = (uint32_t) i, .started = false };
+        ASSERT_TRUE(dyn_array_push_back(queue, &pcb));
+    }
+#ifdef __linux__
+    ASSERT_EQ(0u, (uintptr_t) dyn_array_front(queue) % (2u << 20));
+#endif
+    for (size_t i = 0; i < count; i += 997) {
+        ASSERT_EQ(i, ((ProcessControlBlock_t *) dyn_array_at(queue, i))->arrival);
+    }
+    ASSERT_TRUE(dyn_array_sort_parallel(queue, compare_pcb_burst, 3));
+    ASSERT_EQ(count - 1, ((ProcessControlBlock_t *) dyn_array_front(queue))->arrival);
+    dyn_array_destroy(queue);
+
+    dyn_array_t *plain = dyn_array_create(0, sizeof(ProcessControlBlock_t), NULL);
+    ASSERT_EQ((unsigned int) DYN_ALLOC_DEFAULT, plain->allocation);
+    dyn_array_destroy(plain);
+}
+
+// Schedulers work on the 12 byte copy, the caller's PCBs only see the bursts and started flags come back
+TEST(pcb_table, RoundTripsBurstsAndStarted) {
+    ASSERT_EQ(12u, sizeof(CompactPcb_t));
+    dyn_array_t *ready_queue = dyn_array_create(0, sizeof(ProcessControlBlock_t), NULL);
+    for (uint32_t i = 0; i < 130; ++i) {
+        ProcessControlBlock_t pcb = { .remaining_burst_time = i + 1, .priority = i * 3, .arrival = 1000 - i,
+                                      .started = i % 7 == 0 };
+        ASSERT_TRUE(dyn_array_push_back(ready_queue, &pcb));
+    }
+    PcbTable_t table;
+    ASSERT_TRUE(pcb_table_load(&table, ready_queue));
+    ASSERT_EQ(130u, table.count);
+    ASSERT_EQ(129u * 3, table.pcbs[129].priority);
+    ASSERT_EQ(871u, table.pcbs[129].arrival);
+    ASSERT_FALSE(pcb_table_start(&table, 126));    // started on the way in
+    ASSERT_TRUE(pcb_table_start(&table, 127));
+    ASSERT_FALSE(pcb_table_start(&table, 127));
+    table.pcbs[127].remaining_burst_time = 0;
+    table.pcbs[127].priority = 0;
+    pcb_table_store(&table, ready_queue);
+    pcb_table_release(&table);
+
+    const ProcessControlBlock_t *pcb = (const ProcessControlBlock_t *) dyn_array_at(ready_queue, 127);
+    ASSERT_EQ(0u, pcb->remaining_burst_time);
+    ASSERT_TRUE(pcb->started);
+    ASSERT_EQ(127u * 3, pcb->priority);
+    ASSERT_FALSE(((const ProcessControlBlock_t *) dyn_array_at(ready_queue, 128))->started);
+    ASSERT_TRUE(((const ProcessControlBlock_t *) dyn_array_at(ready_queue, 0))->started);
+
+    dyn_array_t *wrong = dyn_array_create(0, sizeof(uint32_t), NULL);
+    uint32_t value = 1;
+    dyn_array_push_back(wrong, &value);
+    ASSERT_FALSE(pcb_table_load(&table, wrong));
+    ASSERT_EQ(nullptr, table.pcbs);
+    dyn_array_destroy(wrong);
+    dyn_array_destroy(ready_queue);
+}
+
+typedef struct
+{
+    const dyn_array_t *ready_queue;
+    ScheduleResult_t sjf;
+    ScheduleResult_t srtf;
+    bool success;
+}
+ReadonlyRun_t;
+
+static void *run_readonly(void *arg)
+{
+    ReadonlyRun_t *run = (ReadonlyRun_t *) arg;
+    run->success = shortest_job_first_readonly(run->ready_queue, &run->sjf)
+                   && shortest_remaining_time_first_readonly(run->ready_queue, &run->srtf);
+    return NULL;
+}
+
+// shortest_*_readonly: several threads schedule one queue, each matching the in-place schedulers and leaving it alone
+TEST(shortest_readonly, SharedAcrossThreads) {
+    dyn_array_t *ready_queue = dyn_array_create(0, sizeof(ProcessControlBlock_t), NULL);
+    srand(47);
+    for (uint32_t i = 0; i < 2000; ++i) {
+        ProcessControlBlock_t pcb = {(uint32_t) rand() % 50, i, (uint32_t) rand() % 20000, false};
+        dyn_array_push_back(ready_queue, &pcb);
+    }
+    dyn_array_t *sjf_queue = dyn_array_create(0, sizeof(ProcessControlBlock_t), NULL);
+    dyn_array_t *srtf_queue = dyn_array_create(0, sizeof(ProcessControlBlock_t), NULL);
+    dyn_array_append(sjf_queue, dyn_array_front(ready_queue), dyn_array_size(ready_queue));
+    dyn_array_append(srtf_queue, dyn_array_front(ready_queue), dyn_array_size(ready_queue));
+    ScheduleResult_t sjf, srtf;
+    ASSERT_TRUE(shortest_job_first(sjf_queue, &sjf));
+    ASSERT_TRUE(shortest_remaining_time_first(srtf_queue, &srtf));
+
+    ReadonlyRun_t runs[4];
+    pthread_t threads[4];
+    for (size_t i = 0; i < 4; ++i) {
+        runs[i].ready_queue = ready_queue;
+        runs[i].success = false;
+        ASSERT_EQ(0, pthread_create(&threads[i], NULL, run_readonly, &runs[i]));
+    }
+    for (size_t i = 0; i < 4; ++i) {
+        pthread_join(threads[i], NULL);
+        ASSERT_TRUE(runs[i].success);
+        ASSERT_EQ(sjf.average_waiting_time, runs[i].sjf.average_waiting_time);
+        ASSERT_EQ(sjf.average_turnaround_time, runs[i].sjf.average_turnaround_time);
+        ASSERT_EQ(sjf.total_run_time, runs[i].sjf.total_run_time);
+        ASSERT_EQ(srtf.average_waiting_time, runs[i].srtf.average_waiting_time);
+        ASSERT_EQ(srtf.average_turnaround_time, runs[i].srtf.average_turnaround_time);
+        ASSERT_EQ(srtf.total_run_time, runs[i].srtf.total_run_time);
+    }
+    // SRTF should have preempted somewhere in there
+    ASSERT_GT(srtf.context_switches, sjf.context_switches);
+
+    for (uint32_t i = 0; i < 2000; ++i) {
+        const ProcessControlBlock_t *pcb = (const ProcessControlBlock_t *) dyn_array_at(ready_queue, i);
+        ASSERT_EQ(i, pcb->priority);
+        ASSERT_FALSE(pcb->started);
+        ASSERT_EQ(pcb->arrival, ((const ProcessControlBlock_t *) dyn_array_at(sjf_queue, i))->arrival);
+    }
+
+    dyn_array_destroy(sjf_queue);
+    dyn_array_destroy(srtf_queue);
+    dyn_array_destroy(ready_queue);
+}
+
+// dyn_array_of: typed operations agree with the C ones on the same storage, and arrays move between the two
+TEST(dyn_array_of, TypedOpsAndCInterop) {
+    dyn_array_of<ProcessControlBlock_t> typed(4);
+    ASSERT_TRUE((bool) typed);
+    dyn_array_t *reference = dyn_array_create(0, sizeof(ProcessControlBlock_t), NULL);
+    srand(48);
+    for (uint32_t i = 0; i < 1000; ++i) {
+        ProcessControlBlock_t pcb = {(uint32_t) rand() % 100, i, 0, false};
+        ASSERT_TRUE(typed.push_back(pcb));
+        dyn_array_push_back(reference, &pcb);
+    }
+    ASSERT_EQ(1000u, dyn_array_size(typed.get()));
+
+    auto less = [](const ProcessControlBlock_t &a, const ProcessControlBlock_t &b) {
+        return a.remaining_burst_time < b.remaining_burst_time;
+    };
+    ASSERT_TRUE(typed.sort(less));
+    dyn_array_sort(reference, compare_pcb_burst);
+    for (size_t i = 0; i < 1000; ++i) {
+        ASSERT_EQ(((ProcessControlBlock_t *) dyn_array_at(reference, i))->remaining_burst_time,
+                  typed[i].remaining_burst_time);
+    }
+
+    // Same spot as the C insert_sorted, ahead of equal bursts
+    ProcessControlBlock_t extra = {50, 5000, 0, false};
+    ASSERT_TRUE(typed.insert_sorted(extra, less));
+    ASSERT_TRUE(dyn_array_insert_sorted(reference, &extra, compare_pcb_burst));
+    ASSERT_EQ(dyn_array_lower_bound(reference, &extra, compare_pcb_burst), typed.lower_bound(extra, less));
+    ASSERT_EQ(5000u, typed.at(typed.lower_bound(extra, less))->priority);
+    ASSERT_EQ(dyn_array_upper_bound(reference, &extra, compare_pcb_burst), typed.upper_bound(extra, less));
+
+    uint64_t sum = 0;
+    for (const ProcessControlBlock_t &pcb : typed) {
+        sum += pcb.remaining_burst_time;
+    }
+    uint64_t for_each_sum = 0;
+    ASSERT_TRUE(typed.for_each([&](ProcessControlBlock_t &pcb) { for_each_sum += pcb.remaining_burst_time; }));
+    ASSERT_EQ(sum, for_each_sum);
+
+    // Moving hands over the storage, the C side sees the same objects
+    dyn_array_of<ProcessControlBlock_t> moved(std::move(typed));
+    ASSERT_FALSE((bool) typed);
+    ASSERT_EQ(0u, typed.size());
+    ASSERT_EQ(1001u, moved.size());
+    ASSERT_EQ(moved.data(), dyn_array_front(moved.get()));
+    ProcessControlBlock_t last;
+    ASSERT_TRUE(moved.extract_back(last));
+    ASSERT_EQ(last.remaining_burst_time, ((ProcessControlBlock_t *) dyn_array_back(reference))->remaining_burst_time);
+
+    dyn_array_of<ProcessControlBlock_t> adopted = dyn_array_of<ProcessControlBlock_t>::adopt(reference);
+    ASSERT_EQ(1001u, adopted.size());
+    dyn_array_t *released = adopted.release();
+    ASSERT_EQ(reference, released);
+    ASSERT_FALSE(dyn_array_of<uint32_t>::adopt(dyn_array_create(0, sizeof(uint64_t), NULL)));
+    dyn_array_destroy(released);
+}
+
+static void sum_burst_block(void *const first, const size_t count, void *arg) {
+    const ProcessControlBlock_t *pcbs = (const ProcessControlBlock_t *) first;
+    uint64_t *sums = (uint64_t *) arg;
+    for (size_t i = 0; i < count; ++i) {
+        sums[0] += pcbs[i].remaining_burst_time;
+    }
+    ++sums[1];
+}
+
+// dyn_array_for_each_block / dyn_array_reduce_u32: every object seen once in blocks, reductions match a plain loop
+TEST(dyn_array_block, ForEachBlockAndReduce) {
+    dyn_array_t *queue = dyn_array_create(0, sizeof(ProcessControlBlock_t), NULL);
+    dyn_array_u32_reduction_t reduction;
+    ASSERT_TRUE(dyn_array_reduce_u32(queue, offsetof(ProcessControlBlock_t, arrival), &reduction));
+    ASSERT_EQ(0u, reduction.sum);
+    ASSERT_EQ(UINT32_MAX, reduction.min);
+    ASSERT_EQ(0u, reduction.max);
+
+    srand(49);
+    uint64_t sum = 0;
+    uint32_t min = UINT32_MAX, max = 0;
+    for (uint32_t i = 0; i < 1000; ++i) {
+        ProcessControlBlock_t pcb = {(uint32_t) rand(), 0, i + 7, false};
+        dyn_array_push_back(queue, &pcb);
+        sum += pcb.remaining_burst_time;
+        min = std::min(min, pcb.remaining_burst_time);
+        max = std::max(max, pcb.remaining_burst_time);
+    }
+
+    uint64_t sums[2] = {0, 0};
+    ASSERT_TRUE(dyn_array_for_each_block(queue, sum_burst_block, sums, 64));
+    ASSERT_EQ(sum, sums[0]);
+    ASSERT_EQ(16u, sums[1]); // 15 full blocks and a last one of 40
+    sums[0] = sums[1] = 0;
+    ASSERT_TRUE(dyn_array_for_each_block(queue, sum_burst_block, sums, 0));
+    ASSERT_EQ(sum, sums[0]);
+    ASSERT_EQ(1u, sums[1]);
+
+    ASSERT_TRUE(dyn_array_reduce_u32(queue, offsetof(ProcessControlBlock_t, remaining_burst_time), &reduction));
+    ASSERT_EQ(sum, reduction.sum);
+    ASSERT_EQ(min, reduction.min);
+    ASSERT_EQ(max, reduction.max);
+    ASSERT_TRUE(dyn_array_reduce_u32(queue, offsetof(ProcessControlBlock_t, arrival), &reduction));
+    ASSERT_EQ(7u, reduction.min);
+    ASSERT_EQ(1006u, reduction.max);
+    ASSERT_FALSE(dyn_array_reduce_u32(queue, 13, &reduction));
+    ASSERT_FALSE(dyn_array_for_each_block(NULL, sum_burst_block, sums, 0));
+    dyn_array_destroy(queue);
+
+    // An odd object size takes the general path
+    dyn_array_t *triples = dyn_array_create(0, 3 * sizeof(uint32_t) + 1, NULL);
+    uint8_t object[13] = {0};
+    for (uint32_t i = 1; i <= 100; ++i) {
+        memcpy(object + 4, &i, sizeof(i));
+        dyn_array_push_back(triples, object);
+    }
+    ASSERT_TRUE(dyn_array_reduce_u32(triples, 4, &reduction));
+    ASSERT_EQ(5050u, reduction.sum);
+    ASSERT_EQ(1u, reduction.min);
+    ASSERT_EQ(100u, reduction.max);
+    dyn_array_destroy(triples);
+}
+
+static void count_task(const size_t index, void *arg) {
+    __atomic_fetch_add(&((int *) arg)[index], 1, __ATOMIC_RELAXED);
+}
+
+// thread_pool: every task runs exactly once per run, and the pool can be reused
+TEST(thread_pool, RunsEveryTaskOnce) {
+    thread_pool_t *pool = thread_pool_create(4);
+    ASSERT_NE(nullptr, pool);
+    ASSERT_EQ(4u, thread_pool_size(pool));
+    ASSERT_EQ(1u, thread_pool_size(NULL));
+    int counts[1000] = {0};
+    for (int run = 0; run < 50; ++run) {
+        ASSERT_TRUE(thread_pool_run(pool, count_task, counts, 1000));
+    }
+    for (size_t i = 0; i < 1000; ++i) {
+        ASSERT_EQ(50, counts[i]);
+    }
+    ASSERT_TRUE(thread_pool_run(pool, count_task, counts, 0));
+    ASSERT_FALSE(thread_pool_run(NULL, count_task, counts, 1));
+    thread_pool_destroy(pool);
+}
+
+typedef struct
+{
+    uint64_t histogram[16];
+    uint64_t zero_bursts;
+}
+BurstHistogram_t;
+
+static void histogram_block(void *const first, const size_t count, void *accumulator) {
+    const ProcessControlBlock_t *pcbs = (const ProcessControlBlock_t *) first;
+    BurstHistogram_t *histogram = (BurstHistogram_t *) accumulator;
+    for (size_t i = 0; i < count; ++i) {
+        ++histogram->histogram[pcbs[i].remaining_burst_time % 16];
+        histogram->zero_bursts += pcbs[i].remaining_burst_time == 0;
+    }
+}
+
+static void merge_histograms(void *into, const void *from) {
+    BurstHistogram_t *a = (BurstHistogram_t *) into;
+    const BurstHistogram_t *b = (const BurstHistogram_t *) from;
+    for (size_t i = 0; i < 16; ++i) {
+        a->histogram[i] += b->histogram[i];
+    }
+    a->zero_bursts += b->zero_bursts;
+}
+
+// dyn_array_for_each_parallel: per-thread accumulators merged together match one pass on the calling thread
+TEST(dyn_array_parallel, ForEachMatchesSerial) {
+    dyn_array_t *queue = dyn_array_create(0, sizeof(ProcessControlBlock_t), NULL);
+    srand(50);
+    for (uint32_t i = 0; i < 100003; ++i) {
+        ProcessControlBlock_t pcb = {(uint32_t) rand() % 100, 0, i, false};
+        dyn_array_push_back(queue, &pcb);
+    }
+    BurstHistogram_t serial = {};
+    ASSERT_TRUE(dyn_array_for_each_parallel(queue, NULL, histogram_block, &serial, sizeof(serial), merge_histograms));
+
+    thread_pool_t *pool = thread_pool_create(5);
+    for (int run = 0; run < 3; ++run) {
+        BurstHistogram_t parallel[5] = {};
+        ASSERT_TRUE(dyn_array_for_each_parallel(queue, pool, histogram_block, parallel, sizeof(parallel[0]),
+                                                merge_histograms));
+        ASSERT_EQ(0, memcmp(&serial, &parallel[0], sizeof(serial)));
+    }
+
+    // Without accumulators, e.g. work on the PCBs themselves
+    ASSERT_TRUE(dyn_array_for_each_parallel(queue, pool, [](void *const first, const size_t count, void *) {
+        ProcessControlBlock_t *pcbs = (ProcessControlBlock_t *) first;
+        for (size_t i = 0; i < count; ++i) {
+            pcbs[i].started = true;
+        }
+    }, NULL, 0, NULL));
+    for (size_t i = 0; i < dyn_array_size(queue); ++i) {
+        ASSERT_TRUE(((ProcessControlBlock_t *) dyn_array_at(queue, i))->started);
+    }
+    ASSERT_FALSE(dyn_array_for_each_parallel(queue, pool, histogram_block, &serial, 0, NULL));
+
+    thread_pool_destroy(pool);
+    dyn_array_destroy(queue);
 }
 
 int main(int argc, char **argv) 